@@ -0,0 +1,2500 @@
+#include "cam.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#endif
+#if LIB_PICO_STDIO_UART
+#include "pico/stdio_uart.h"
+#endif
+#include "hardware/clocks.h"
+
+// decoded images, core1 fills one while core0 uses the other
+static volatile cameraImage_t pictures[NUMPICTURES];
+// the decoded image that findLine, setPixel and printImage work on
+static volatile cameraImage_t *pic = &pictures[0];
+
+// capture state
+static volatile uint8_t saveImage = 0; // user requests image
+static volatile uint8_t startImage = 0; // got a start of frame
+static volatile uint8_t startCollect = 0; // got a start of row
+static volatile uint32_t rawIndex = 0;
+static volatile uint32_t hsCount = 0;
+static volatile uint32_t vsCount = 0;
+
+// frame ring, capture fills writeFrame while vision holds readFrame
+static volatile int8_t writeFrame = 0; // buffer being captured
+static volatile int8_t readyFrame = -1; // newest complete buffer not yet taken by vision
+static volatile int8_t readFrame = -1; // buffer held by vision
+static volatile int8_t lastFrame = 0; // newest complete buffer
+static volatile uint8_t continuous = 0; // keep capturing after each frame
+static volatile frameInfo_t frameInfo[NUMFRAMES]; // what capture saw of each frame
+static volatile uint32_t frameCount = 0;
+static volatile uint32_t droppedFrames = 0;
+static volatile uint32_t shortFrames = 0; // rows or bytes missing
+static volatile uint32_t longFrames = 0; // rows past the end
+static volatile int8_t doneFrame = -1; // frame that finished last, while the sensor may still send rows
+static volatile uint32_t captureStart = 0; // time_us_32 at the VS that started the frame being captured
+static volatile uint8_t rowsTorn = 0; // a row of the frame being captured ended early
+
+// motion gating, vision compares each frame's signature with the last one it worked on
+static uint8_t changeThreshold = CAM_CHANGE_THRESHOLD;
+static uint8_t visionSig[HISTBANDS][SIGZONES];
+static uint8_t visionSigValid = 0;
+static uint32_t skippedFrames = 0;
+
+// line detector, and for LINE_EDGE where it last found the line in each row and how
+// wide it was there in half pixels, -1 for not yet
+static uint8_t lineDetector = LINE_CENTROID;
+static uint8_t edgeThreshold = CAM_EDGE_THRESHOLD;
+static int16_t edgeLast[MAXSIZEY];
+static int16_t edgeWidth[MAXSIZEY];
+
+// output format, YUV keeps only the Y byte so a frame is half the size
+// the sensor sends sensorWidth x sensorHeight, binning shrinks that to the
+// imageWidth x imageHeight frame of frameFormat that vision sees
+#define CAM_BIN_SHIFT (CAM_BIN == 4 ? 2 : CAM_BIN - 1)
+#if CAM_FIXED
+// constants, so every loop over a frame is compiled for this one size
+static const OV7670_colorspace pixelFormat = CAM_FORMAT;
+static const OV7670_size imageSize = CAM_SIZE;
+static const uint8_t binShift = CAM_BIN_SHIFT;
+static const uint32_t sensorWidth = IMAGESIZEX;
+static const uint32_t sensorHeight = IMAGESIZEY;
+static const uint8_t packFrames = CAM_PACK;
+static const uint8_t frameFormat = CAM_PACK ? FRAME_FORMAT_MASK : CAM_BIN > 1 ? OV7670_COLOR_YUV : CAM_FORMAT;
+static const uint32_t imageWidth = IMAGESIZEX/CAM_BIN;
+static const uint32_t imageHeight = IMAGESIZEY/CAM_BIN;
+static const uint32_t frameBytes = CAM_FRAME_BYTES;
+#else
+static volatile OV7670_colorspace pixelFormat = CAM_FORMAT;
+static volatile OV7670_size imageSize = CAM_SIZE;
+static volatile uint8_t binShift = CAM_BIN_SHIFT;
+static volatile uint32_t sensorWidth = IMAGESIZEX;
+static volatile uint32_t sensorHeight = IMAGESIZEY;
+static volatile uint8_t packFrames = CAM_PACK;
+static volatile uint8_t frameFormat = CAM_PACK ? FRAME_FORMAT_MASK : CAM_BIN > 1 ? OV7670_COLOR_YUV : CAM_FORMAT;
+static volatile uint32_t imageWidth = IMAGESIZEX/CAM_BIN;
+static volatile uint32_t imageHeight = IMAGESIZEY/CAM_BIN;
+static volatile uint32_t frameBytes = CAM_PACK ? ((IMAGESIZEX/CAM_BIN + 7)/8)*(IMAGESIZEY/CAM_BIN) : (IMAGESIZEX/CAM_BIN)*(IMAGESIZEY/CAM_BIN)*(CAM_FORMAT == OV7670_COLOR_YUV || CAM_BIN > 1 ? 1 : 2);
+#endif
+static volatile uint32_t numFrames = NUMFRAMES; // how many frames of frameBytes the ring uses
+static volatile uint32_t wantFrames = NUMFRAMES; // how many setNumFrames asked for
+static volatile uint32_t lastFrameUs = 0; // when the previous frame finished
+static volatile uint32_t framePeriodUs = 0; // smoothed time between frames
+
+// raw frames are cut from one pool so they can change size
+static volatile uint8_t cameraData[CAM_POOL_BYTES] __attribute__((aligned(4)));
+
+static inline volatile uint8_t *frameData(int frame){
+    return cameraData + frame*frameBytes;
+}
+
+// binning and packing, each sensor row is captured whole into binRows and added to
+// binSum, every 1<<binShift rows the sums become one row of the frame
+#if CAM_FIXED && CAM_BIN == 1 && !CAM_PACK
+#define BINROWBYTES 4 // never used
+#else
+#define BINROWBYTES (MAXSIZEX*2)
+#endif
+static volatile uint8_t binRows[2][BINROWBYTES] __attribute__((aligned(4)));
+static uint16_t binSum[MAXSIZEX]; // 4x4 of 255 still fits
+// packed frames are thresholded per band at the Otsu level of the frame before
+static uint16_t packHist[HISTBANDS][HISTBINS];
+static uint8_t packThreshold[HISTBANDS];
+
+// capture goes a row at a time through binRows rather than straight into the frame
+static inline int rowMode(){
+    return binShift || packFrames;
+}
+
+// bytes in a row of a packed frame
+static inline uint32_t maskRowBytes(){
+    return (imageWidth + 7) >> 3;
+}
+
+// pixel col of a packed row
+static inline int maskBit(volatile uint8_t *p, int col){
+    return (p[col >> 3] >> (col & 7)) & 1;
+}
+
+// bytes the sensor sends per row that capture keeps
+static inline uint32_t sensorRowBytes(){
+    return sensorWidth*(pixelFormat == OV7670_COLOR_YUV ? 1 : 2);
+}
+
+// luminance (r + 2g + b)/4 straight from RGB565
+static inline uint8_t rgbLuma(uint8_t lo, uint8_t hi){
+    return ((hi & 0xF8) + (((((hi&0b111)<<3) | lo>>5)<<2)<<1) + ((lo&0b11111)<<3)) >> 2;
+}
+
+// start a frame with empty bin sums, and empty histograms so a frame cut off
+// part way doesn't leave its rows in the next frame's thresholds
+void binClear(){
+    int i;
+    for(i=0;i<imageWidth;i++){
+        binSum[i] = 0;
+    }
+    if (packFrames){
+        for(i=0;i<HISTBANDS*HISTBINS;i++){
+            packHist[i/HISTBINS][i%HISTBINS] = 0;
+        }
+    }
+}
+
+// add sensor row hsCount (counting from 1) to the bin sums, on the last row of a bin
+// write the averages out as the next row of writeFrame
+void binRow(volatile uint8_t *p){
+    int i;
+    if (pixelFormat == OV7670_COLOR_YUV){
+        for(i=0;i<sensorWidth;i++){
+            binSum[i >> binShift] += p[i];
+        }
+    }
+    else {
+        for(i=0;i<sensorWidth;i++){
+            binSum[i >> binShift] += rgbLuma(p[2*i], p[2*i+1]);
+        }
+    }
+    uint32_t rowBytes = packFrames ? maskRowBytes() : imageWidth;
+    if ((hsCount & ((1 << binShift) - 1)) != 0 || rawIndex + rowBytes > frameBytes){
+        return;
+    }
+    volatile uint8_t *out = frameData(writeFrame) + rawIndex;
+    int shift = 2*binShift;
+    if (packFrames){
+        // 8 pixels a byte, column 0 in bit 0, 1 for brighter than the band's threshold
+        int band = getBand(rawIndex / rowBytes);
+        uint16_t *hist = packHist[band];
+        int t = packThreshold[band];
+        uint8_t bits = 0;
+        for(i=0;i<imageWidth;i++){
+            int v = binSum[i] >> shift;
+            binSum[i] = 0;
+            hist[v]++;
+            bits |= (v > t) << (i & 7);
+            if ((i & 7) == 7){
+                out[i >> 3] = bits;
+                bits = 0;
+            }
+        }
+        if (imageWidth & 7){
+            out[imageWidth >> 3] = bits;
+        }
+        rawIndex += rowBytes;
+        if (rawIndex == frameBytes){
+            // thresholds for the next frame
+            for(i=0;i<HISTBANDS;i++){
+                packThreshold[i] = otsuThreshold(packHist[i], packThreshold[i]);
+            }
+        }
+        return;
+    }
+    for(i=0;i<imageWidth;i++){
+        out[i] = binSum[i] >> shift;
+        binSum[i] = 0;
+    }
+    rawIndex += rowBytes;
+}
+void resizeFrames();
+static uint8_t captureReady = 0; // capture interrupts are set up
+static uint8_t cameraReady = 0; // init_camera has run
+static uint32_t bringUpUs = 0; // how long init_camera_pins took
+static uint8_t fastMode = 0; // see setFastMode
+void writeClock();
+static uint32_t initMismatches = 0; // init registers that did not read back as written
+
+// shadow copy of the camera registers, so a field can be changed with one write and no read
+#define SHADOW_VALID 1 // shadowValue is what the camera has, or will have after a flush
+#define SHADOW_DIRTY 2 // changed by OV7670_set_register, not written yet
+static uint8_t shadowValue[256];
+static uint8_t shadowState[256];
+
+// coarse brightness grid of a frame, each cell averages 4 pixels spread over it,
+// 128 reads so it is cheap enough for the end of frame interrupt
+void frameSignature(volatile uint8_t *raw, uint8_t sig[HISTBANDS][SIGZONES]){
+    int band;
+    int zone;
+    int i;
+    int cellH = imageHeight/HISTBANDS;
+    int cellW = imageWidth/SIGZONES;
+    for(band=0;band<HISTBANDS;band++){
+        for(zone=0;zone<SIGZONES;zone++){
+            int sum = 0;
+            for(i=0;i<4;i++){
+                int row = band*cellH + ((i & 1) ? 3*cellH/4 : cellH/4);
+                int col = zone*cellW + ((i & 2) ? 3*cellW/4 : cellW/4);
+                int index = row*imageWidth + col;
+                if (frameFormat == FRAME_FORMAT_MASK){
+                    sum += maskBit(raw + row*maskRowBytes(), col) ? 255 : 0;
+                }
+                else if (frameFormat == OV7670_COLOR_YUV){
+                    sum += raw[index];
+                }
+                else {
+                    sum += rgbLuma(raw[2*index], raw[2*index+1]);
+                }
+            }
+            sig[band][zone] = sum >> 2;
+        }
+    }
+}
+
+// capture into writeFrame finished, publish it and move on to a free buffer
+void frameDone(){
+    int i;
+    uint32_t now = time_us_32();
+    if (lastFrameUs != 0 && continuous){
+        uint32_t period = now - lastFrameUs;
+        framePeriodUs = (framePeriodUs == 0) ? period : (framePeriodUs*7 + period)/8;
+    }
+    lastFrameUs = now;
+    frameCount++;
+    volatile frameInfo_t *info = &frameInfo[writeFrame];
+    info->seq = frameCount;
+    info->start = captureStart;
+    info->end = now;
+    info->rows = hsCount;
+    info->bytes = rawIndex;
+    info->complete = (hsCount == sensorHeight && rawIndex == frameBytes && !rowsTorn);
+    if (!info->complete){
+        shortFrames++;
+    }
+    else {
+        frameSignature(frameData(writeFrame), (uint8_t (*)[SIGZONES])info->sig);
+    }
+    doneFrame = writeFrame;
+    if (readyFrame >= 0){
+        droppedFrames++; // vision never took the previous one
+    }
+    readyFrame = writeFrame;
+    lastFrame = writeFrame;
+    // the next free buffer round the ring, so the rest hold the newest frames as history
+    // with fewer than 3 frames there may be no free one, then keep overwriting
+    for(i=1;i<=numFrames;i++){
+        int next = (writeFrame + i) % numFrames;
+        if (next != readyFrame && next != readFrame){
+            writeFrame = next;
+            break;
+        }
+    }
+    if (!continuous){
+        saveImage = 0;
+    }
+}
+
+#if CAM_USE_PIO
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "cam.pio.h"
+
+// PIO waits on VS/HS/PCLK and pushes D0-D7, DMA copies the bytes to the frame
+static PIO cam_pio = pio0;
+static uint cam_sm;
+static uint cam_offset;
+static const pio_program_t *cam_program = NULL;
+static uint cam_dma;
+static dma_channel_config cam_dma_config;
+static uint8_t binBuf = 0; // binRows buffer DMA is filling
+
+void startCapture();
+
+static volatile uint32_t vsFalls = 0; // VS falls seen by the CPU
+static volatile uint32_t armVsFalls = 0; // vsFalls when the frame was armed
+
+// the state machine waits for VS itself, this only watches it to time frames
+// and to notice a frame that ran into the next one
+void vs_callback(uint gpio, uint32_t events){
+    vsFalls++;
+    if (vsFalls == armVsFalls + 1){
+        captureStart = time_us_32(); // the VS the state machine started on
+    }
+}
+
+// DMA has filled the frame buffer, or one row when binning or packing
+void dma_handler(){
+    dma_channel_acknowledge_irq0(cam_dma);
+    if (rowMode()){
+        // row at a time, DMA stops after every row, the next row can't start before HS
+        // so there is time to point it at the other buffer before binning this one
+        uint8_t done = binBuf;
+        hsCount++;
+        if (hsCount < sensorHeight){
+            binBuf ^= 1;
+            dma_channel_transfer_to_buffer_now(cam_dma, binRows[binBuf], sensorRowBytes()/4);
+        }
+        binRow(binRows[done]);
+        if (hsCount < sensorHeight){
+            return;
+        }
+    }
+    else {
+        rawIndex = frameBytes;
+        hsCount = sensorHeight;
+    }
+    // the state machine always stores rows x bytes, but if the sensor sent fewer
+    // rows than that it carried on into the next frame past another VS
+    rowsTorn = (vsFalls - armVsFalls) > 1;
+    frameDone();
+    if (saveImage){
+        startCapture(); // continuous, go straight on to the next buffer
+    }
+}
+
+// load the capture program for the pixel format, replacing the old one
+void loadCaptureProgram(){
+    pio_sm_set_enabled(cam_pio, cam_sm, false);
+    if (cam_program != NULL){
+        pio_remove_program(cam_pio, cam_program, cam_offset);
+    }
+    if (pixelFormat == OV7670_COLOR_YUV){
+        cam_program = &cam_capture_luma_program;
+        cam_offset = pio_add_program(cam_pio, cam_program);
+        cam_capture_luma_program_init(cam_pio, cam_sm, cam_offset, D0);
+    }
+    else {
+        cam_program = &cam_capture_program;
+        cam_offset = pio_add_program(cam_pio, cam_program);
+        cam_capture_program_init(cam_pio, cam_sm, cam_offset, D0);
+    }
+}
+
+// load the capture program and claim a DMA channel for it,
+// the DMA interrupt runs on the core that calls this
+void init_capture(){
+    cam_sm = pio_claim_unused_sm(cam_pio, true);
+    loadCaptureProgram();
+
+    cam_dma = dma_claim_unused_channel(true);
+    cam_dma_config = dma_channel_get_default_config(cam_dma);
+    channel_config_set_transfer_data_size(&cam_dma_config, DMA_SIZE_32);
+    channel_config_set_read_increment(&cam_dma_config, false);
+    channel_config_set_write_increment(&cam_dma_config, true);
+    channel_config_set_dreq(&cam_dma_config, pio_get_dreq(cam_pio, cam_sm, false));
+
+    dma_channel_set_irq0_enabled(cam_dma, true);
+    irq_set_exclusive_handler(DMA_IRQ_0, dma_handler);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    // new image starts on falling VS
+    gpio_set_irq_enabled_with_callback(VS, GPIO_IRQ_EDGE_FALL, true, &vs_callback);
+}
+
+// stop the state machine and DMA wherever they are
+void stopCapture(){
+    pio_sm_set_enabled(cam_pio, cam_sm, false);
+    dma_channel_abort(cam_dma);
+    dma_channel_acknowledge_irq0(cam_dma);
+}
+
+// arm the state machine and DMA for the next full frame
+void startCapture(){
+    stopCapture();
+    rawIndex = 0;
+    hsCount = 0;
+    armVsFalls = vsFalls;
+    pio_sm_clear_fifos(cam_pio, cam_sm);
+    pio_sm_restart(cam_pio, cam_sm);
+    pio_sm_exec(cam_pio, cam_sm, pio_encode_jmp(cam_offset));
+    if (rowMode()){
+        binClear();
+        binBuf = 0;
+        dma_channel_configure(cam_dma, &cam_dma_config, binRows[0], &cam_pio->rxf[cam_sm], sensorRowBytes()/4, true);
+    }
+    else {
+        dma_channel_configure(cam_dma, &cam_dma_config, frameData(writeFrame), &cam_pio->rxf[cam_sm], frameBytes/4, true);
+    }
+    pio_sm_put(cam_pio, cam_sm, sensorHeight-1);
+    pio_sm_put(cam_pio, cam_sm, sensorRowBytes()-1);
+    pio_sm_set_enabled(cam_pio, cam_sm, true);
+}
+#else
+void gpio_callback(uint gpio, uint32_t events);
+
+// interrupts, they run on the core that calls this
+void init_capture(){
+    // new image starts on falling VS
+    gpio_set_irq_enabled_with_callback(VS, GPIO_IRQ_EDGE_FALL, true, &gpio_callback);
+    // new row starts on rising HS
+    gpio_set_irq_enabled_with_callback(HS, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+    // read byte on rising PCLK
+    gpio_set_irq_enabled_with_callback(PCLK, GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+}
+
+void gpio_callback(uint gpio, uint32_t events) {
+    uint32_t pins = gpio_get_all();
+    // only PCLK edges while HS is high carry a byte, PCLK keeps running through
+    // the blanking and those edges would fill out a row that lost one
+    if (gpio == PCLK && !(pins & (1u << HS))){
+        return;
+    }
+    captureEvent(gpio, gpio == PCLK ? pins & 0xFF : 0);
+}
+
+// the capture state machine, one call per VS fall, HS rise or PCLK rise with the
+// byte on D0-D7, it does not touch the pins so a recorded or made up signal can
+// be fed through it the same way
+void captureEvent(uint gpio, uint8_t data){
+    if (gpio == VS){
+        //printf("v\n");
+        doneFrame = -1; // no more rows for it
+        if (saveImage && startImage){
+            frameDone(); // the last one never got all its rows
+            startImage = 0;
+        }
+        if (saveImage==1){
+            //printf("v\n");
+            captureStart = time_us_32();
+            rowsTorn = 0;
+            binClear();
+            rawIndex = 0;
+            hsCount = 0;
+            vsCount = 0;
+            startImage = 1;
+            startCollect = 0;
+        }
+    }
+    if (gpio == HS){
+        //printf("h");
+        if(saveImage){
+            if (startImage){
+                if (hsCount == sensorHeight){
+                    // a row past the last one, bytes went missing, give up on the frame
+                    //printf("%d",hsCount);
+                    frameDone();
+                    startImage = 0;
+                    startCollect = 0;
+                }
+                else {
+                    if (startCollect){
+                        rowsTorn = 1; // the last row didn't get all its bytes
+                    }
+                    startCollect = 1;
+                    hsCount++;
+                    vsCount = 0; // rows stay lined up even if a PCLK was missed
+                }
+            }
+        }
+        if (!startImage && doneFrame >= 0){
+            // rows after the frame was already full, the sensor sends more than we asked for
+            // the frame itself is fine, but the window is set wrong
+            if (frameInfo[doneFrame].complete){
+                longFrames++;
+            }
+            doneFrame = -1;
+        }
+    }
+    if (gpio == PCLK){
+        if(saveImage){
+            if(startImage){
+                if(startCollect){
+                    vsCount++;
+                    // read the raw data, in YUV only the Y byte (1st of each pair)
+                    if (pixelFormat == OV7670_COLOR_RGB || (vsCount & 1)){
+                        if (rowMode()){
+                            binRows[0][pixelFormat == OV7670_COLOR_RGB ? vsCount-1 : vsCount>>1] = data;
+                        }
+                        else {
+                            frameData(writeFrame)[rawIndex] = data;
+                            rawIndex++;
+                        }
+                    }
+                    if (vsCount == sensorWidth*2){
+                        startCollect = 0;
+                        vsCount = 0;
+                        if (rowMode()){
+                            binRow(binRows[0]);
+                        }
+                    }
+                    if (rawIndex == frameBytes){
+                        frameDone();
+                        startImage = 0;
+                        startCollect = 0;
+                    }
+                }
+            }
+        }
+    }
+}
+#endif
+
+// setup the camera pins
+void init_camera_pins(){
+    uint32_t start = time_us_32();
+    resizeFrames(); // cut the pool for the boot size
+
+    // 8 data pins
+    gpio_init(D0);
+    gpio_set_dir(D0, GPIO_IN);
+    gpio_init(D1);
+    gpio_set_dir(D1, GPIO_IN);
+    gpio_init(D2);
+    gpio_set_dir(D2, GPIO_IN);
+    gpio_init(D3);
+    gpio_set_dir(D3, GPIO_IN);
+    gpio_init(D4);
+    gpio_set_dir(D4, GPIO_IN);
+    gpio_init(D5);
+    gpio_set_dir(D5, GPIO_IN);
+    gpio_init(D6);
+    gpio_set_dir(D6, GPIO_IN);
+    gpio_init(D7);
+    gpio_set_dir(D7, GPIO_IN);
+
+    gpio_init(RST); // reset pin
+    gpio_set_dir(RST, GPIO_OUT);
+    gpio_put(RST, 1);
+
+    gpio_init(PWDN); // powerdown pin
+    gpio_set_dir(PWDN, GPIO_OUT);
+    gpio_put(PWDN, 0);
+
+    // set MCLK to 50% 25MHz PWM -> actually only 18.75MHz
+    gpio_set_function(MCLK, GPIO_FUNC_PWM); // Set the LED Pin to be PWM
+    uint slice_num = pwm_gpio_to_slice_num(MCLK); // Get PWM slice number
+    float div = 2; // must be between 1-255, 2 for 25MHz
+    pwm_set_clkdiv(slice_num, div); // divider
+    uint16_t wrap = 3; // when to rollover, must be less than 65535
+    pwm_set_wrap(slice_num, wrap);
+    pwm_set_enabled(slice_num, true); // turn on the PWM
+    pwm_set_gpio_level(MCLK, wrap / 2); // set the duty cycle to 50%
+
+    // powerdown and restart, init_camera waits until it answers
+    gpio_put(PWDN, 1);
+    sleep_ms(1);
+    gpio_put(PWDN, 0);
+
+    // I2C Initialisation. Using it at 100Khz.
+    i2c_init(I2C_PORT, 100*1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+    
+    printf("Start init camera\n");
+    init_camera();
+    printf("End init camera\n");
+
+    gpio_init(VS); // vertical sync
+    gpio_set_dir(VS, GPIO_IN);
+    gpio_init(HS); // horizontal sync
+    gpio_set_dir(HS, GPIO_IN);
+    gpio_init(PCLK); // pixel clock
+    gpio_set_dir(PCLK, GPIO_IN);
+
+    bringUpUs = time_us_32() - start;
+#if CAM_VERIFY_INIT
+    printf("camera up in %d ms, %d registers did not read back\n", (int)(bringUpUs/1000), (int)initMismatches);
+#else
+    printf("camera up in %d ms\n", (int)(bringUpUs/1000));
+#endif
+
+    // capture interrupts are set up on the first setSaveImage(), on whichever core calls it
+}
+
+// write the colorspace registers for pixelFormat
+void writePixelFormat(){
+    if (pixelFormat == OV7670_COLOR_YUV){
+        OV7670_write_table(OV7670_yuv);
+    }
+    else {
+        OV7670_write_table(OV7670_rgb);
+    }
+}
+
+// frame layout changed, cut the pool into new frames and forget the old ones
+void resizeFrames(){
+    int i;
+#if !CAM_FIXED
+    imageWidth = sensorWidth >> binShift;
+    imageHeight = sensorHeight >> binShift;
+    if (packFrames){
+        frameFormat = FRAME_FORMAT_MASK;
+        frameBytes = maskRowBytes()*imageHeight;
+    }
+    else {
+        frameFormat = binShift ? OV7670_COLOR_YUV : pixelFormat;
+        frameBytes = imageWidth*imageHeight*(frameFormat == OV7670_COLOR_YUV ? 1 : 2);
+    }
+#endif
+    numFrames = CAM_POOL_BYTES/frameBytes;
+    if (numFrames > wantFrames){
+        numFrames = wantFrames;
+    }
+    visionSigValid = 0; // nothing to compare the new frames with
+    for(i=0;i<MAXSIZEY;i++){
+        edgeLast[i] = -1;
+        edgeWidth[i] = -1;
+    }
+    // nothing is bright until a band has had a line in it to split
+    for(i=0;i<HISTBANDS;i++){
+        packThreshold[i] = 255;
+    }
+    for(i=0;i<NUMPICTURES*HISTBANDS;i++){
+        pictures[i/HISTBANDS].threshold[i%HISTBANDS] = 255;
+    }
+    writeFrame = 0;
+    readyFrame = -1;
+    readFrame = -1;
+    lastFrame = 0;
+    lastFrameUs = 0;
+    framePeriodUs = 0;
+}
+
+// choose RGB565 or YUV (Y only), can be called before or after init_camera_pins
+void setPixelFormat(OV7670_colorspace format){
+#if CAM_FIXED
+    return; // CAM_FORMAT it is
+#endif
+    uint8_t wasContinuous = continuous;
+    if (captureReady){
+        setContinuous(0);
+    }
+#if !CAM_FIXED
+    pixelFormat = format;
+#endif
+    resizeFrames();
+    if (cameraReady){
+        writePixelFormat();
+    }
+#if CAM_USE_PIO
+    if (captureReady){
+        loadCaptureProgram();
+    }
+#endif
+    if (wasContinuous){
+        setContinuous(1);
+    }
+}
+
+// vision reads rows a word at a time, so a binned row must be whole words
+static int binFits(uint32_t width, int shift){
+    return ((width >> shift) & 3) == 0;
+}
+
+// average bin x bin pixels (1 = off, 2 or 4) into one luminance byte while the rows
+// arrive, frames are then Y only and getImageWidth() x getImageHeight() is the
+// sensor size / bin, so a bigger sensor size costs no more RAM or vision time
+// returns 0 if bin is not supported at this size, 1 if it was set
+int setBinning(int bin){
+#if CAM_FIXED
+    return bin == CAM_BIN;
+#endif
+    int shift = (bin == 4) ? 2 : bin - 1;
+    if ((bin != 1 && bin != 2 && bin != 4) || !binFits(sensorWidth, shift)){
+        return 0;
+    }
+    uint8_t wasContinuous = continuous;
+    if (captureReady){
+        setContinuous(0);
+    }
+#if !CAM_FIXED
+    binShift = shift;
+#endif
+    resizeFrames();
+    if (wasContinuous){
+        setContinuous(1);
+    }
+    return 1;
+}
+
+int getBinning(){
+    return 1 << binShift;
+}
+
+// 1 to threshold every pixel into 1 bit as the rows arrive, after binning if that is on,
+// a frame is then FRAME_FORMAT_MASK, (getImageWidth()+7)/8 bytes a row with column 0 in
+// bit 0 of the first byte, 600 bytes at 80x60. Each band is thresholded at the Otsu
+// level of the frame before, so the first frame comes out empty, and a band with
+// nothing to split, all floor or all line, keeps its threshold
+// returns 1 if it was set
+int setPackedFrames(int on){
+#if CAM_FIXED
+    return !on == !CAM_PACK;
+#endif
+    uint8_t wasContinuous = continuous;
+    if (captureReady){
+        setContinuous(0);
+    }
+#if !CAM_FIXED
+    packFrames = (on != 0);
+#endif
+    resizeFrames();
+    if (wasContinuous){
+        setContinuous(1);
+    }
+    return 1;
+}
+
+int getPackedFrames(){
+    return packFrames;
+}
+
+// Window settings were tediously determined empirically.
+// I hope there's a formula for this, if a do-over is needed.
+//{vstart,hstart,edge_offset,pclk_delay}
+static const uint16_t windows[5][4] = {
+    {9, 162, 2, 2},  // SIZE_DIV1  640x480 VGA
+    {10, 174, 4, 2}, // SIZE_DIV2  320x240 QVGA
+    {11, 186, 2, 2}, // SIZE_DIV4  160x120 QQVGA
+    {12, 210, 0, 2}, // SIZE_DIV8  80x60   ...
+    {15, 252, 3, 2}, // SIZE_DIV16 40x30
+};
+
+// write the scaling, PCLK divider and window registers for a size
+void writeSize(OV7670_size size){
+    uint8_t value;
+    uint16_t vstart = windows[size][0];
+    uint16_t hstart = windows[size][1];
+    uint16_t edge_offset = windows[size][2];
+    uint16_t pclk_delay = windows[size][3];
+
+    // Enable downsampling if sub-VGA, and zoom if 1:16 scale
+    value = (size > OV7670_SIZE_DIV1) ? OV7670_COM3_DCWEN : 0;
+    if (size == OV7670_SIZE_DIV16)
+    value |= OV7670_COM3_SCALEEN;
+    OV7670_set_register(OV7670_REG_COM3, 0xFF, value);
+
+    // Enable PCLK division if sub-VGA 2,4,8,16 = 0x19,1A,1B,1C
+    value = (size > OV7670_SIZE_DIV1) ? (0x18 + size) : 0;
+    OV7670_set_register(OV7670_REG_COM14, 0xFF, value);
+
+    // Horiz/vert downsample ratio, 1:8 max (H,V are always equal for now)
+    value = (size <= OV7670_SIZE_DIV8) ? size : OV7670_SIZE_DIV8;
+    OV7670_set_register(OV7670_REG_SCALING_DCWCTR, 0xFF, value * 0x11);
+
+    // Pixel clock divider if sub-VGA
+    value = (size > OV7670_SIZE_DIV1) ? (0xF0 + size) : 0x08;
+    OV7670_set_register(OV7670_REG_SCALING_PCLK_DIV, 0xFF, value);
+
+    // Apply 0.5 digital zoom at 1:16 size (others are downsample only)
+    value = (size == OV7670_SIZE_DIV16) ? 0x40 : 0x20; // 0.5, 1.0
+    // Modify only scaling bits, test pattern settings are also stored
+    // in SCALING_XSC and SCALING_YSC and we don't want to corrupt them.
+    OV7670_set_register(OV7670_REG_SCALING_XSC, 0x7F, value);
+    OV7670_set_register(OV7670_REG_SCALING_YSC, 0x7F, value);
+
+    // Window size is scattered across multiple registers.
+    // Horiz/vert stops can be automatically calc'd from starts.
+    uint16_t vstop = vstart + 480;
+    uint16_t hstop = (hstart + 640) % 784;
+    OV7670_set_register(OV7670_REG_HSTART, 0xFF, hstart >> 3);
+    OV7670_set_register(OV7670_REG_HSTOP, 0xFF, hstop >> 3);
+    OV7670_set_register(OV7670_REG_HREF, 0xFF, (edge_offset << 6) | ((hstop & 0b111) << 3) | (hstart & 0b111));
+    OV7670_set_register(OV7670_REG_VSTART, 0xFF, vstart >> 2);
+    OV7670_set_register(OV7670_REG_VSTOP, 0xFF, vstop >> 2);
+    OV7670_set_register(OV7670_REG_VREF, 0x0F, ((vstop & 0b11) << 2) | (vstart & 0b11)); // top bits are gain
+    OV7670_set_register(OV7670_REG_SCALING_PCLK_DELAY, 0xFF, pclk_delay);
+    OV7670_flush();
+}
+
+// change the image size, 40x30 (DIV16) up to CAM_MAX_SIZE, 320x240 (DIV2) at most
+// returns 0 if the size is not supported, 1 if it was set
+int setResolution(OV7670_size size){
+#if CAM_FIXED
+    return size == CAM_SIZE;
+#endif
+    if (size < CAM_MAX_SIZE || size < OV7670_SIZE_DIV2 || size > OV7670_SIZE_DIV16 || !binFits(640 >> size, binShift)){
+        return 0;
+    }
+    uint8_t wasContinuous = continuous;
+    if (captureReady){
+        setContinuous(0);
+    }
+#if !CAM_FIXED
+    imageSize = size;
+    sensorWidth = 640 >> size;
+    sensorHeight = 480 >> size;
+#endif
+    resizeFrames();
+    if (cameraReady){
+        writeSize(size);
+    }
+    if (wasContinuous){
+        setContinuous(1);
+    }
+    return 1;
+}
+
+uint32_t getImageWidth(){
+    return imageWidth;
+}
+
+uint32_t getImageHeight(){
+    return imageHeight;
+}
+
+// write CLKRC and DBLV for the capture backend and fast mode
+// the sensor always reads out the whole array, so the frame rate only depends on
+// this clock and not on the resolution
+void writeClock(){
+#if CAM_USE_PIO
+    // 18.75MHz * 6 PLL / 5 = 22.5MHz for 27fps, the fastest under the 24MHz rating
+    // only fast mode with CAM_OVERCLOCK goes past it, * 4 / 2 = 37.5MHz, see cam.h
+    if (fastMode && CAM_OVERCLOCK){
+        OV7670_write_register(OV7670_REG_CLKRC, 1); // div 2
+        OV7670_write_register(OV7670_REG_DBLV, 0x4A); // pll x4
+    }
+    else {
+        OV7670_write_register(OV7670_REG_CLKRC, 4); // div 5
+        OV7670_write_register(OV7670_REG_DBLV, 0x8A); // pll x6
+    }
+#else
+    // 25MHz * PLL / divisor = 24MHz for 30fps -> actually only 5fps
+    // an interrupt per byte can't go any faster, fast mode only changes the exposure
+    OV7670_write_register(OV7670_REG_CLKRC, 1); // div 1
+    OV7670_write_register(OV7670_REG_DBLV, 0); // no pll
+#endif
+    // old frame times don't say anything about the new clock
+    lastFrameUs = 0;
+    framePeriodUs = 0;
+}
+
+// turn auto exposure and gain off and use these, exposure in rows (about 65us
+// each at 27fps), gain 0x00 is 1x, 0x10 2x, 0x30 4x, 0x70 8x
+void setFixedExposure(uint16_t rows, uint16_t gain){
+    OV7670_update_register(OV7670_REG_COM8, OV7670_COM8_AEC | OV7670_COM8_AGC, 0);
+    OV7670_set_exposure(rows);
+    OV7670_set_gain(gain);
+}
+
+// let the camera pick exposure and gain
+void setAutoExposure(){
+    OV7670_update_register(OV7670_REG_COM8, OV7670_COM8_AEC | OV7670_COM8_AGC, OV7670_COM8_AEC | OV7670_COM8_AGC);
+}
+
+// fast mode for a moving robot: short fixed exposure so the line doesn't smear,
+// CAM_FAST_GAIN to make up the light, and with CAM_OVERCLOCK a faster clock
+// off puts back the clock, exposure and gain from before
+void setFastMode(uint32_t on){
+    static uint8_t com8;
+    static uint8_t exposure[3]; // AECHH, AECH, COM1
+    static uint8_t gain[2]; // GAIN, VREF
+    if (on == fastMode){
+        return;
+    }
+    if (on){
+        com8 = OV7670_get_register(OV7670_REG_COM8);
+        exposure[0] = OV7670_get_register(OV7670_REG_AECHH);
+        exposure[1] = OV7670_get_register(OV7670_REG_AECH);
+        exposure[2] = OV7670_get_register(OV7670_REG_COM1);
+        gain[0] = OV7670_get_register(OV7670_REG_GAIN);
+        gain[1] = OV7670_get_register(OV7670_REG_VREF);
+        fastMode = 1;
+        setFixedExposure(CAM_FAST_EXPOSURE, CAM_FAST_GAIN);
+    }
+    else {
+        fastMode = 0;
+        OV7670_set_register(OV7670_REG_AECHH, 0x3F, exposure[0]);
+        OV7670_set_register(OV7670_REG_AECH, 0xFF, exposure[1]);
+        OV7670_set_register(OV7670_REG_COM1, 0x03, exposure[2]);
+        OV7670_set_register(OV7670_REG_GAIN, 0xFF, gain[0]);
+        OV7670_set_register(OV7670_REG_VREF, 0xC0, gain[1]);
+        OV7670_flush();
+        OV7670_update_register(OV7670_REG_COM8, OV7670_COM8_AEC | OV7670_COM8_AGC, com8);
+    }
+    writeClock();
+}
+
+// wait for VS to fall, 0 if it didn't within timeout_us
+static int waitVsFall(uint32_t timeout_us){
+    uint32_t start = time_us_32();
+    while (!gpio_get(VS)){
+        if (time_us_32() - start > timeout_us){
+            return 0;
+        }
+    }
+    while (gpio_get(VS)){
+        if (time_us_32() - start > timeout_us){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// time between frames straight from the VS pin, whether or not they are captured,
+// averaged over frames, blocks that long, 0 if VS isn't toggling
+uint32_t measureFramePeriod(int frames){
+    uint32_t start = 0;
+    int i;
+    if (frames < 1){
+        return 0;
+    }
+    for(i=0;i<=frames;i++){
+        if (!waitVsFall(1000000)){
+            return 0;
+        }
+        if (i == 0){
+            start = time_us_32();
+        }
+    }
+    return (time_us_32() - start) / frames;
+}
+
+// frames per second actually captured in continuous mode, 0 until measured
+float getFrameRate(){
+    if (framePeriodUs == 0){
+        return 0;
+    }
+    return 1000000.0f / framePeriodUs;
+}
+
+OV7670_colorspace getPixelFormat(){
+    return pixelFormat;
+}
+
+// init the camera with RST and I2C commands
+void init_camera(){
+    // hardware reset the camera
+    gpio_put(RST, 0);
+    sleep_ms(1);
+    gpio_put(RST, 1);
+    if (!OV7670_wait_ready(CAM_READY_MS)){
+        printf("camera did not answer, check the wiring\n");
+    }
+
+    OV7670_write_register(OV7670_REG_COM7, OV7670_COM7_RESET); // software reset
+    sleep_ms(1); // registers are back to default 1ms later
+    OV7670_wait_ready(CAM_READY_MS);
+    initMismatches = 0;
+
+    // perform all the I2C writes for init
+    writeClock();
+
+    // init regular registers
+    OV7670_write_table(OV7670_init);
+
+    // set colorspace to RGB565 or YUV
+    writePixelFormat();
+    cameraReady = 1;
+
+    // init image size
+    writeSize(imageSize);
+
+    // no settling delay, the first few frames come out while exposure adjusts
+
+    //OV7670_test_pattern(OV7670_TEST_PATTERN_NONE);
+    //OV7670_test_pattern(OV7670_TEST_PATTERN_COLOR_BAR);
+}
+
+// how long init_camera_pins took, in us
+uint32_t getBringUpTime(){
+    return bringUpUs;
+}
+
+// poll PID/VER until the camera answers with the right IDs, 0 if it never did
+int OV7670_wait_ready(uint32_t timeout_ms){
+    uint32_t start = time_us_32();
+    while (time_us_32() - start < timeout_ms*1000){
+        uint8_t pid;
+        uint8_t ver;
+        if (OV7670_read_checked(OV7670_REG_PID, &pid) && OV7670_read_checked(OV7670_REG_VER, &ver)
+            && pid == OV7670_PID && ver == OV7670_VER){
+            return 1;
+        }
+        sleep_us(200);
+    }
+    return 0;
+}
+
+// write a {reg, value} table up to its 0xff end marker, back to back
+// with CAM_VERIFY_INIT each register is read back and written once more if it
+// did not stick, returns how many still did not match
+int OV7670_write_table(const uint8_t table[][2]){
+    int bad = 0;
+    int i;
+    for(i=0; table[i][0] != 0xff; i++){
+        OV7670_write_register(table[i][0], table[i][1]);
+#if CAM_VERIFY_INIT
+        uint8_t v;
+        if (!OV7670_read_checked(table[i][0], &v) || v != table[i][1]){
+            OV7670_write_register(table[i][0], table[i][1]);
+            if (!OV7670_read_checked(table[i][0], &v) || v != table[i][1]){
+                printf("reg 0x%02x wrote 0x%02x read 0x%02x\n", table[i][0], table[i][1], v);
+                bad++;
+            }
+        }
+#endif
+    }
+    initMismatches = initMismatches + bad;
+    return bad;
+}
+
+// Selects one of the camera's test patterns (or disable).
+// See Adafruit_OV7670.h for notes about minor visual bug here.
+void OV7670_test_pattern(OV7670_pattern pattern) {
+    // Only the top bits, so image scaling settings aren't corrupted.
+    // The shadow has the rest, so there is no I2C read.
+    OV7670_update_register(OV7670_REG_SCALING_XSC, 0x80, (pattern & 1) ? 0x80 : 0);
+    OV7670_update_register(OV7670_REG_SCALING_YSC, 0x80, (pattern & 2) ? 0x80 : 0);
+  }
+
+// I2C write to the camera
+void OV7670_write_register(uint8_t reg, uint8_t value){
+    uint8_t buf[2];
+    buf[0] = reg;
+    buf[1] = value;
+    i2c_write_blocking(I2C_PORT, OV7670_ADDR, buf, 2, false); // SCCB needs no delay between writes
+    shadowValue[reg] = value;
+    shadowState[reg] = SHADOW_VALID;
+    if (reg == OV7670_REG_COM7 && (value & OV7670_COM7_RESET)){
+        // everything went back to defaults we don't know
+        int i;
+        for(i=0;i<256;i++){
+            shadowState[i] = 0;
+        }
+    }
+}
+
+// I2C read from the camera, 0 if it did not answer
+int OV7670_read_checked(uint8_t reg, uint8_t *value){
+    *value = 0;
+    if (i2c_write_blocking(I2C_PORT, OV7670_ADDR, &reg, 1, false) != 1){  // true to keep master control of bus
+        return 0;
+    }
+    if (i2c_read_blocking(I2C_PORT, OV7670_ADDR, value, 1, false) != 1){  // false - finished with bus
+        return 0;
+    }
+    if (!(shadowState[reg] & SHADOW_DIRTY)){
+        shadowValue[reg] = *value;
+        shadowState[reg] = SHADOW_VALID;
+    }
+    return 1;
+}
+
+// registers the auto exposure, gain and white balance loops change on their own,
+// the shadow can't be trusted for them while those loops are on
+static int shadowStale(uint8_t reg){
+    uint8_t com8 = shadowValue[OV7670_REG_COM8];
+    if (!(shadowState[OV7670_REG_COM8] & SHADOW_VALID)){
+        com8 = 0xFF; // don't know, assume everything is on
+    }
+    switch (reg){
+        case OV7670_REG_GAIN:
+        case OV7670_REG_VREF: // gain bits 9:8
+            return (com8 & OV7670_COM8_AGC) != 0;
+        case OV7670_REG_AECHH:
+        case OV7670_REG_AECH:
+        case OV7670_REG_COM1: // exposure bits 1:0
+            return (com8 & OV7670_COM8_AEC) != 0;
+        case OV7670_REG_BLUE:
+        case OV7670_REG_RED:
+            return (com8 & OV7670_COM8_AWB) != 0;
+        default:
+            return 0;
+    }
+}
+
+// value of a register from the shadow, only read over I2C if it was never
+// written or read, or the camera may have changed it
+uint8_t OV7670_get_register(uint8_t reg){
+    if (shadowState[reg] & SHADOW_DIRTY){
+        return shadowValue[reg]; // the camera gets it on the next flush
+    }
+    if ((shadowState[reg] & SHADOW_VALID) && !shadowStale(reg)){
+        return shadowValue[reg];
+    }
+    return OV7670_read_register(reg);
+}
+
+// change the mask bits of a register, one write and only if they changed
+void OV7670_update_register(uint8_t reg, uint8_t mask, uint8_t value){
+    uint8_t old = (mask == 0xFF) ? shadowValue[reg] : OV7670_get_register(reg); // whole register, no need to know it
+    uint8_t v = (old & ~mask) | (value & mask);
+    if (v != old || !(shadowState[reg] & SHADOW_VALID) || (shadowState[reg] & SHADOW_DIRTY)){
+        OV7670_write_register(reg, v);
+    }
+}
+
+// like OV7670_update_register but only in the shadow, OV7670_flush writes it
+void OV7670_set_register(uint8_t reg, uint8_t mask, uint8_t value){
+    uint8_t old = (mask == 0xFF) ? shadowValue[reg] : OV7670_get_register(reg); // whole register, no need to know it
+    uint8_t v = (old & ~mask) | (value & mask);
+    if (v != old || !(shadowState[reg] & SHADOW_VALID)){
+        shadowValue[reg] = v;
+        shadowState[reg] = SHADOW_VALID | SHADOW_DIRTY;
+    }
+}
+
+// write every register OV7670_set_register changed, in address order
+// with CAM_SCCB_BURST a run of neighbouring registers goes in one transfer
+void OV7670_flush(){
+    int reg = 0;
+    while (reg < 256){
+        if (!(shadowState[reg] & SHADOW_DIRTY)){
+            reg++;
+            continue;
+        }
+#if CAM_SCCB_BURST
+        uint8_t buf[1 + 32];
+        int n = 0;
+        buf[0] = reg;
+        while (reg + n < 256 && (shadowState[reg + n] & SHADOW_DIRTY) && n < 32){
+            buf[1 + n] = shadowValue[reg + n];
+            shadowState[reg + n] = SHADOW_VALID;
+            n++;
+        }
+        i2c_write_blocking(I2C_PORT, OV7670_ADDR, buf, 1 + n, false);
+        reg = reg + n;
+#else
+        OV7670_write_register(reg, shadowValue[reg]);
+        reg++;
+#endif
+    }
+}
+
+// exposure time in rows, 16 bits scattered over AECHH, AECH and COM1
+// only sticks with AEC off, see COM8
+void OV7670_set_exposure(uint16_t rows){
+    OV7670_set_register(OV7670_REG_AECHH, 0x3F, rows >> 10);
+    OV7670_set_register(OV7670_REG_AECH, 0xFF, rows >> 2);
+    OV7670_set_register(OV7670_REG_COM1, 0x03, rows);
+    OV7670_flush();
+}
+
+// analog gain, 10 bits in GAIN and the top of VREF, only sticks with AGC off
+void OV7670_set_gain(uint16_t gain){
+    OV7670_set_register(OV7670_REG_GAIN, 0xFF, gain);
+    OV7670_set_register(OV7670_REG_VREF, 0xC0, (gain >> 8) << 6);
+    OV7670_flush();
+}
+
+// I2C read from the camera
+uint8_t OV7670_read_register(uint8_t reg){
+    uint8_t buf;
+    OV7670_read_checked(reg, &buf);
+    return buf;
+}
+
+// save an image
+void setSaveImage(uint32_t s){
+    if (!captureReady){
+        init_capture();
+        captureReady = 1;
+    }
+#if CAM_USE_PIO
+    if (s){
+        saveImage = 1;
+        startCapture();
+    }
+    else {
+        stopCapture();
+        saveImage = 0;
+    }
+#else
+    saveImage = s;
+#endif
+}
+
+// keep capturing frames into the ring until turned off
+void setContinuous(uint32_t c){
+    continuous = c;
+    setSaveImage(c);
+}
+
+// take the newest complete frame for vision, -1 if there is no new one
+int acquireFrame(){
+    uint32_t status = save_and_disable_interrupts();
+    int f = readyFrame;
+    if (f >= 0){
+        readFrame = f;
+        readyFrame = -1;
+    }
+    restore_interrupts(status);
+    return f;
+}
+
+// give the frame held by vision back to capture
+void releaseFrame(){
+    readFrame = -1;
+}
+
+// sequence number of a frame in the ring, counts up from 1
+uint32_t getFrameSeq(int frame){
+    return frameInfo[frame].seq;
+}
+
+// ring buffer holding frame seq, -1 if it has been overwritten, capture keeps going
+// round the ring so with more frames there is more history, and a frame other than
+// the one acquired may change while it is read, check getFrameSeq() afterwards
+int findFrame(uint32_t seq){
+    int i;
+    for(i=0;i<numFrames;i++){
+        if (seq != 0 && frameInfo[i].seq == seq){
+            return i;
+        }
+    }
+    return -1;
+}
+
+// what capture saw of a frame in the ring
+void getFrameInfo(int frame, frameInfo_t *info){
+    *info = *(frameInfo_t *)&frameInfo[frame];
+}
+
+// 1 if every row and byte of a frame arrived, vision should skip it otherwise
+int frameComplete(int frame){
+    return frameInfo[frame].complete;
+}
+
+// 1 if a frame looks different enough from the last one this said 1 for that vision
+// should work on it, 0 if it can keep the line it found then, which counts as skipped
+// a cell has to move by more than the change threshold, so slow drift still adds up
+int frameChanged(int frame){
+    int band;
+    int zone;
+    int changed = !visionSigValid || changeThreshold == 0;
+    volatile uint8_t (*sig)[SIGZONES] = frameInfo[frame].sig;
+    for(band=0;band<HISTBANDS && !changed;band++){
+        for(zone=0;zone<SIGZONES;zone++){
+            int d = sig[band][zone] - visionSig[band][zone];
+            if (d > changeThreshold || d < -changeThreshold){
+                changed = 1;
+                break;
+            }
+        }
+    }
+    if (!changed){
+        skippedFrames++;
+        return 0;
+    }
+    for(band=0;band<HISTBANDS;band++){
+        for(zone=0;zone<SIGZONES;zone++){
+            visionSig[band][zone] = sig[band][zone];
+        }
+    }
+    visionSigValid = 1;
+    return 1;
+}
+
+// brightness levels a signature cell must move before frameChanged says 1, 0 turns gating off
+void setChangeThreshold(uint8_t levels){
+    changeThreshold = levels;
+}
+
+// frames frameChanged let vision skip
+uint32_t getSkippedFrames(){
+    return skippedFrames;
+}
+
+// frames that came out with rows or bytes missing
+uint32_t getShortFrames(){
+    return shortFrames;
+}
+
+// frames the sensor sent more rows for than asked, only the interrupt backend can tell
+uint32_t getLongFrames(){
+    return longFrames;
+}
+
+// time_us_32 when a frame in the ring finished
+uint32_t getFrameTime(int frame){
+    return frameInfo[frame].end;
+}
+
+// how many raw frames the ring cycles through: 2 is double buffering, 3 lets
+// vision keep one while capture fills another and one waits, more only helps
+// when vision is slower than capture now and then
+// limited by NUMFRAMES and how many frames of this size fit in the pool, returns how many it got
+int setNumFrames(int n){
+    if (n < 1){
+        n = 1;
+    }
+    if (n > NUMFRAMES){
+        n = NUMFRAMES;
+    }
+    uint8_t wasContinuous = continuous;
+    if (captureReady){
+        setContinuous(0);
+    }
+    wantFrames = n;
+    resizeFrames();
+    if (wasContinuous){
+        setContinuous(1);
+    }
+    return numFrames;
+}
+
+int getNumFrames(){
+    return numFrames;
+}
+
+// bytes in one raw frame at the current size and format
+uint32_t getFrameBytes(){
+    return frameBytes;
+}
+
+// raw bytes of a frame in the ring, 0 to getNumFrames()-1, as captured
+volatile uint8_t *getFrameBuffer(int frame){
+    return frameData(frame);
+}
+
+// the decoded picture findLine and setPixel use
+volatile cameraImage_t *getPicture(){
+    return pic;
+}
+
+// complete frames captured so far
+uint32_t getFrameCount(){
+    return frameCount;
+}
+
+// complete frames overwritten before vision acquired them
+uint32_t getDroppedFrames(){
+    return droppedFrames;
+}
+
+// dual core mode: core1 captures and decodes, core0 gets finished pictures
+#define QUEUELEN 4 // more than NUMPICTURES so a push never finds it full
+static volatile cameraFrame_t frameQueue[QUEUELEN]; // written by core1 only
+static volatile uint32_t queueHead = 0; // next slot core1 writes, only core1 changes it
+static volatile uint32_t queueTail = 0; // next slot core0 reads, only core0 changes it
+static volatile uint8_t pictureBusy[NUMPICTURES]; // set by core1, cleared by core0
+static volatile int8_t heldPicture = -1; // picture core0 is working on
+static volatile uint64_t idleUs[2]; // time each core spent waiting
+static uint64_t startUs = 0;
+
+void core1_entry(){
+    setContinuous(1);
+    while (true) {
+        uint64_t t = time_us_64();
+        int p = -1;
+        while (p < 0){
+            int i;
+            for(i=0;i<NUMPICTURES;i++){
+                if (!pictureBusy[i]){
+                    p = i;
+                    break;
+                }
+            }
+        }
+        int f;
+        while((f = acquireFrame()) < 0 || !frameComplete(f)){
+            if (f >= 0){
+                releaseFrame(); // torn, don't bother decoding it
+            }
+        }
+        idleUs[1] += time_us_64() - t;
+
+        convertFrame(frameData(f), &pictures[p]);
+        releaseFrame();
+
+        cameraFrame_t *d = (cameraFrame_t *)&frameQueue[queueHead % QUEUELEN];
+        d->seq = frameInfo[f].seq;
+        d->picture = p;
+        d->time = time_us_32();
+        pictureBusy[p] = 1;
+        __dmb(); // descriptor and picture are written before core0 can see them
+        queueHead++;
+    }
+}
+
+// hand capture and RGB565 decode to core1
+void startCameraCore1(){
+    startUs = time_us_64();
+    multicore_launch_core1(core1_entry);
+}
+
+// wait for the newest picture from core1 and make it the one findLine works on,
+// the previous picture goes back to core1
+void waitPicture(cameraFrame_t *frame){
+    if (heldPicture >= 0){
+        __dmb(); // done with the picture before core1 may reuse it
+        pictureBusy[heldPicture] = 0;
+        heldPicture = -1;
+    }
+    uint64_t t = time_us_64();
+    while (queueTail == queueHead){}
+    idleUs[0] += time_us_64() - t;
+    __dmb();
+    // skip to the newest, giving back any older pictures
+    while (queueTail + 1 != queueHead){
+        pictureBusy[frameQueue[queueTail % QUEUELEN].picture] = 0;
+        queueTail++;
+    }
+    *frame = frameQueue[queueTail % QUEUELEN];
+    queueTail++;
+    heldPicture = frame->picture;
+    pic = &pictures[frame->picture];
+}
+
+// percent of time a core was busy since startCameraCore1
+uint32_t getCoreLoad(uint core){
+    uint64_t total = time_us_64() - startUs;
+    if (total == 0 || core > 1){
+        return 0;
+    }
+    return 100 - (uint32_t)(idleUs[core]*100/total);
+}
+
+// see if you are supposed to be saving an image
+uint32_t getSaveImage(){
+    return saveImage;
+}
+
+// how many rows were counted, should be getImageHeight()
+uint32_t getHSCount(){
+    return hsCount;
+}
+
+// how many bytes were saved, should be 2*width*height for RGB565
+// or width*height for YUV
+uint32_t getPixelCount(){
+    return rawIndex;
+}
+
+// which histogram band a row is in
+int getBand(int row){
+    return row*HISTBANDS/imageHeight;
+}
+
+// convert a raw frame to RGB, Y only frames come out gray
+// the brightness histogram of each band is counted in the same pass, then thresholded
+// a picture holds at most IMAGESIZEX*IMAGESIZEY pixels, bigger frames are left out
+// https://blog.usedbytes.com/2022/02/pico-pio-camera/
+void convertFrame(volatile uint8_t *raw, volatile cameraImage_t *out){
+    out->index = 0;
+    int i = 0;
+    int row;
+    int col;
+    int pixels = imageWidth*imageHeight;
+    if (pixels > IMAGESIZEX*IMAGESIZEY){
+        return;
+    }
+    for(i=0;i<HISTBANDS*HISTBINS;i++){
+        out->hist[i/HISTBINS][i%HISTBINS] = 0;
+    }
+    i = 0;
+    if (frameFormat == FRAME_FORMAT_MASK){
+        for(row=0;row<imageHeight;row++){
+            volatile uint16_t *hist = out->hist[getBand(row)];
+            volatile uint8_t *p = raw + row*maskRowBytes();
+            for(col=0;col<imageWidth;col++){
+                uint8_t y = maskBit(p, col) ? 255 : 0;
+                out->r[i] = y;
+                out->g[i] = y;
+                out->b[i] = y;
+                hist[y]++;
+                i++;
+            }
+        }
+    }
+    else if (frameFormat == OV7670_COLOR_YUV){
+        for(row=0;row<imageHeight;row++){
+            volatile uint16_t *hist = out->hist[getBand(row)];
+            for(col=0;col<imageWidth;col++){
+                uint8_t y = raw[i];
+                out->r[i] = y;
+                out->g[i] = y;
+                out->b[i] = y;
+                hist[y]++;
+                i++;
+            }
+        }
+    }
+    else {
+        for(row=0;row<imageHeight;row++){
+            volatile uint16_t *hist = out->hist[getBand(row)];
+            for(col=0;col<imageWidth;col++){
+                uint8_t lo = raw[2*i];
+                uint8_t hi = raw[2*i+1];
+                uint8_t r = (hi>>3)<<3;
+                uint8_t g = (((hi&0b111)<<3) | lo>>5)<<2;
+                uint8_t b = (lo&0b11111)<<3;
+                out->r[i] = r;
+                out->g[i] = g;
+                out->b[i] = b;
+                hist[(r + g + b) >> 2]++;
+                i++;
+            }
+        }
+    }
+    out->index = i;
+    for(i=0;i<HISTBANDS;i++){
+        out->threshold[i] = otsuThreshold(out->hist[i], out->threshold[i]);
+    }
+}
+
+// Otsu's threshold, the split of the histogram with the most variance between
+// the dark and bright sides, pixels above it are bright
+// one pass over the bins, so the cost does not depend on the image size
+// if even the best split leaves the two sides' means less than CAM_OTSU_SEPARATION
+// apart the band is all floor or all line, then previous is kept
+uint8_t otsuThreshold(volatile uint16_t *hist, uint8_t previous){
+    int32_t total = 0;
+    int64_t sumAll = 0;
+    int i;
+    for(i=0;i<HISTBINS;i++){
+        total = total + hist[i];
+        sumAll = sumAll + (int64_t)i*hist[i];
+    }
+
+    int32_t dark = 0; // pixels at or below i
+    int64_t sumDark = 0;
+    float best = -1.0f;
+    uint8_t threshold = 0;
+    int32_t bestDark = 0;
+    int64_t bestSumDark = 0;
+    for(i=0;i<HISTBINS-1;i++){
+        dark = dark + hist[i];
+        sumDark = sumDark + (int64_t)i*hist[i];
+        int32_t bright = total - dark;
+        if (dark == 0){
+            continue;
+        }
+        if (bright == 0){
+            break;
+        }
+        // between class variance times total^2, the mean difference scaled up
+        // by dark*bright*total keeps it in integers until here
+        float d = (float)(sumDark*total - sumAll*dark);
+        float v = d*d / ((float)dark*(float)bright);
+        if (v > best){
+            best = v;
+            threshold = i;
+            bestDark = dark;
+            bestSumDark = sumDark;
+        }
+    }
+    // one occupied bin never gets a split, otherwise compare the means,
+    // sumBright/bright - sumDark/dark without dividing
+    int32_t bestBright = total - bestDark;
+    if (bestDark == 0 || bestBright == 0
+        || (sumAll - bestSumDark)*bestDark - bestSumDark*bestBright < (int64_t)CAM_OTSU_SEPARATION*bestDark*bestBright){
+        return previous;
+    }
+    return threshold;
+}
+
+// bright pixels of picture as 1, dark as 0, picture itself is left alone
+static uint8_t lineMask[IMAGESIZEX*IMAGESIZEY];
+
+// threshold one row of picture into lineMask, returns how many pixels are bright
+static int thresholdRow(int row){
+    int r = row*imageWidth;
+    int t = pic->threshold[getBand(row)];
+    int n = 0;
+    int i;
+    for(i=0;i<imageWidth;i++){
+        int bin = (frameFormat != OV7670_COLOR_RGB) ? pic->r[r+i] : (pic->r[r+i] + pic->g[r+i] + pic->b[r+i]) >> 2;
+        lineMask[r+i] = bin > t;
+        n = n + lineMask[r+i];
+    }
+    return n;
+}
+
+// threshold the whole picture into lineMask
+void thresholdPicture(){
+    int row;
+    if (pic->index < imageWidth*imageHeight){
+        return;
+    }
+    for(row=0;row<imageHeight;row++){
+        thresholdRow(row);
+    }
+}
+
+// imageWidth x imageHeight bytes, 1 for line, valid for rows findLine or thresholdPicture did
+const uint8_t *getLineMask(){
+    return lineMask;
+}
+
+// convert the frame held by vision, or else the newest one, into picture
+void convertImage(){
+    pic = &pictures[0];
+    convertFrame(frameData(readFrame >= 0 ? readFrame : lastFrame), pic);
+}
+
+// threshold a row at its band's Otsu threshold into lineMask and find the center
+// of mass of the bright pixels, -1 if the picture is empty or nothing is bright
+int findLine(int row){
+    int r = row*imageWidth; // find the index of the start of the row in the pixel array
+    if (row < 0 || r + imageWidth > pic->index){
+        return -1;
+    }
+    if (thresholdRow(row) == 0){
+        return -1;
+    }
+    int sumMass = 0;
+    int sumMassR = 0;
+    int i;
+
+    // calculate the center of mass of the thresholded row
+    for(i=0;i<imageWidth;i++){
+        sumMass = sumMass + lineMask[r+i];
+        sumMassR = sumMassR + lineMask[r+i]*i;
+    }
+    return sumMassR / sumMass;
+}
+
+// decode the brightness (r+g+b, or Y) of one row of a raw frame, returns the row sum
+int rowBrightness(volatile uint8_t *raw, int row, uint16_t *bright){
+    int sumBright = 0;
+    int i;
+
+    if (frameFormat == FRAME_FORMAT_MASK){
+        volatile uint8_t *p = raw + row*maskRowBytes();
+        for(i=0;i<imageWidth;i++){
+            bright[i] = maskBit(p, i) ? 255 : 0;
+            sumBright = sumBright + bright[i];
+        }
+    }
+    else if (frameFormat == OV7670_COLOR_YUV){
+        // the Y bytes are the brightness already
+        volatile uint8_t *p = raw + row*imageWidth;
+        for(i=0;i<imageWidth;i++){
+            bright[i] = p[i];
+            sumBright = sumBright + p[i];
+        }
+    }
+    else {
+        // decode brightness r+g+b and sum the row in one pass
+        volatile uint8_t *p = raw + row*imageWidth*2;
+        for(i=0;i<imageWidth;i++){
+            uint8_t lo = p[2*i];
+            uint8_t hi = p[2*i+1];
+            int mass = (hi & 0xF8) + ((((hi&0b111)<<3) | lo>>5)<<2) + ((lo&0b11111)<<3);
+            bright[i] = mass;
+            sumBright = sumBright + mass;
+        }
+    }
+    return sumBright;
+}
+
+// line center of one row with the chosen detector, in 1/256 pixels
+static int rowLine(int detector, volatile uint8_t *raw, int row, int *count){
+    if (detector == LINE_EDGE){
+        return rowEdges(raw, row, count);
+    }
+    return rowCenter(raw, row, count);
+}
+
+// line center of one row straight from the raw bytes, decodes only that row and
+// does not touch picture, thresholds at the row average rather than Otsu,
+// or with LINE_EDGE -1 if no edges pair up
+int findLineRaw(volatile uint8_t *raw, int row){
+    int count;
+    return rowLine(lineDetector, raw, row, &count) >> 8;
+}
+
+// LINE_CENTROID or LINE_EDGE, for findLineRaw, findLineFrame, fitLineRaw, fitLineFrame and trackLine
+void setLineDetector(int detector){
+    lineDetector = detector;
+}
+
+int getLineDetector(){
+    return lineDetector;
+}
+
+// how big a brightness step across 2 pixels LINE_EDGE takes as an edge
+void setEdgeThreshold(uint8_t step){
+    edgeThreshold = step;
+}
+
+// 0x80 in each byte where a >= b
+static inline uint32_t swarGe(uint32_t a, uint32_t b){
+    // compare the low 7 bits without borrowing between bytes then fix up with the top bits
+    uint32_t low = (a | 0x80808080) - (b & 0x7F7F7F7F);
+    return ((a & ~b) | (~(a ^ b) & low)) & 0x80808080;
+}
+
+// a - b in each byte, 0 where b > a
+static inline uint32_t swarSubSat(uint32_t a, uint32_t b){
+    uint32_t diff = ((a | 0x80808080) - (b & 0x7F7F7F7F)) ^ ((a ^ ~b) & 0x80808080);
+    return diff & ((swarGe(a, b) >> 7) * 0xFF);
+}
+
+// 0x80 in bytes 0-3 of x to bits 0-3, the multiply moves each bit to the top nibble
+static inline uint32_t swarBits(uint32_t x){
+    return ((x >> 7) * 0x10204080) >> 28;
+}
+
+// set bits in a word
+static inline uint32_t popcount32(uint32_t x){
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (x * 0x01010101) >> 24;
+}
+
+// runs of set bits between columns lo and hi-1 of a row bitmap as their centers
+// in half pixels, first + last
+static int bitRuns(const uint32_t *bits, int lo, int hi, int16_t *centers, int max){
+    int n = 0;
+    int i = lo;
+    while (i < hi && n < max){
+        uint32_t w = bits[i >> 5] >> (i & 31);
+        if (w == 0){
+            i = (i | 31) + 1;
+            continue;
+        }
+        i += __builtin_ctz(w);
+        if (i >= hi){
+            break;
+        }
+        int first = i;
+        while (i < hi && ((bits[i >> 5] >> (i & 31)) & 1)){
+            i++;
+        }
+        centers[n++] = first + i - 1;
+    }
+    return n;
+}
+
+#define MAXEDGES 16 // per direction per row
+
+// line center between columns lo and hi-1 of a row from its edges in 1/256 pixels,
+// -256 if there is none, count is its width
+// takes the derivative y[i+1] - y[i-1] of the row's brightness 4 pixels a word, marks
+// where it rises or falls by more than the edge threshold, pairs each rising edge with
+// the next falling one, the end of the range standing in for an edge a line runs off
+// past, and of the pairs narrower than half the image keeps the one nearest where the
+// line was in this row last time and closest to the width it was, a pixel off in
+// either costing the same. Only the words holding the range and their neighbours are read.
+static int edgeLine(volatile uint8_t *raw, int row, int lo, int hi, int *count){
+    uint32_t luma[MAXSIZEX/4];
+    uint32_t rise[MAXSIZEX/32 + 1];
+    uint32_t fall[MAXSIZEX/32 + 1];
+    int16_t up[MAXEDGES];
+    int16_t down[MAXEDGES];
+    int nUp = 0;
+    int nDown = 0;
+    int words = imageWidth/4;
+    int i;
+
+    if (frameFormat == FRAME_FORMAT_MASK){
+        // each run of line pixels is a pair already, edges half a pixel outside it
+        volatile uint8_t *p = raw + row*maskRowBytes();
+        i = lo;
+        while (i < hi && nUp < MAXEDGES){
+            if ((i & 7) == 0 && p[i >> 3] == 0){
+                i += 8;
+                continue;
+            }
+            if (!maskBit(p, i)){
+                i++;
+                continue;
+            }
+            up[nUp++] = 2*i - 1;
+            while (i < hi && maskBit(p, i)){
+                i++;
+            }
+            down[nDown++] = 2*(i-1) + 1;
+        }
+    }
+    else {
+        // words holding the range, and one either side for the derivative at its ends
+        int first = lo >> 2;
+        int last = (hi + 3) >> 2;
+        int readFirst = first > 0 ? first - 1 : 0;
+        int readLast = last < words ? last + 1 : words;
+
+        // brightness as bytes, Y as it is or (r+g+b)/4 two pixels at a time
+        if (frameFormat == OV7670_COLOR_YUV){
+            volatile uint32_t *p = (volatile uint32_t *)(raw + row*imageWidth);
+            for(i=readFirst;i<readLast;i++){
+                luma[i] = p[i];
+            }
+        }
+        else {
+            volatile uint32_t *p = (volatile uint32_t *)(raw + row*imageWidth*2);
+            for(i=readFirst;i<readLast;i++){
+                uint32_t a = p[2*i];
+                uint32_t b = p[2*i+1];
+                uint32_t ma = ((((a >> 8) & 0x00F800F8) + ((a >> 3) & 0x00FC00FC) + ((a << 3) & 0x00F800F8)) >> 2) & 0x00FF00FF;
+                uint32_t mb = ((((b >> 8) & 0x00F800F8) + ((b >> 3) & 0x00FC00FC) + ((b << 3) & 0x00F800F8)) >> 2) & 0x00FF00FF;
+                luma[i] = ((ma | (ma >> 8)) & 0xFFFF) | ((mb | (mb >> 8)) << 16);
+            }
+        }
+
+        // derivative, the pixels either side of each one come from shifting in the neighbour words
+        uint32_t t = edgeThreshold * 0x01010101;
+        for(i=first>>3;i<=(last-1)>>3;i++){
+            rise[i] = 0;
+            fall[i] = 0;
+        }
+        for(i=first;i<last;i++){
+            uint32_t w = luma[i];
+            uint32_t prev = (w << 8) | (i > 0 ? luma[i-1] >> 24 : w & 0xFF);
+            uint32_t next = (w >> 8) | ((i < words-1 ? luma[i+1] & 0xFF : w >> 24) << 24);
+            int shift = (i & 7)*4;
+            rise[i >> 3] |= swarBits(swarGe(swarSubSat(next, prev), t)) << shift;
+            fall[i >> 3] |= swarBits(swarGe(swarSubSat(prev, next), t)) << shift;
+        }
+        nUp = bitRuns(rise, lo, hi, up, MAXEDGES);
+        nDown = bitRuns(fall, lo, hi, down, MAXEDGES);
+
+        // a line running off the side has no edge there, the border is its edge
+        if (nDown > 0 && (nUp == 0 || down[0] < up[0])){
+            for(i=(nUp < MAXEDGES ? nUp : MAXEDGES-1);i>0;i--){
+                up[i] = up[i-1];
+            }
+            up[0] = 2*lo - 1;
+            if (nUp < MAXEDGES){
+                nUp++;
+            }
+        }
+        if (nUp > 0 && (nDown == 0 || up[nUp-1] > down[nDown-1]) && nDown < MAXEDGES){
+            down[nDown++] = 2*hi - 1;
+        }
+    }
+
+    // the line is brighter than the floor, so it starts with a rise and ends with a fall
+    int hint = edgeLast[row] >= 0 ? 2*edgeLast[row] : imageWidth; // half pixels
+    int wantWidth = edgeWidth[row]; // half pixels, -1 for any
+    int best = -1;
+    int bestWidth = 0;
+    int bestDist = 0;
+    int j = 0;
+    for(i=0;i<nUp;i++){
+        while (j < nDown && down[j] <= up[i]){
+            j++;
+        }
+        if (j == nDown){
+            break;
+        }
+        int width = down[j] - up[i]; // half pixels
+        if (width >= imageWidth){
+            continue; // half the image or more is floor, not line
+        }
+        int center = up[i] + down[j]; // quarter pixels
+        int dist = center - 2*hint;
+        if (dist < 0){
+            dist = -dist;
+        }
+        if (wantWidth >= 0){
+            dist = dist + 2*(width > wantWidth ? width - wantWidth : wantWidth - width);
+        }
+        if (best < 0 || dist < bestDist){
+            best = center;
+            bestWidth = width;
+            bestDist = dist;
+        }
+    }
+    if (best < 0){
+        *count = 0;
+        return -256;
+    }
+    edgeLast[row] = best >> 2;
+    edgeWidth[row] = bestWidth;
+    *count = (bestWidth + 1) >> 1;
+    return best << 6;
+}
+
+// edgeLine over the whole row
+int rowEdges(volatile uint8_t *raw, int row, int *count){
+    return edgeLine(raw, row, 0, imageWidth, count);
+}
+
+// findLine as it was before the detectors worked on raw frames: r+g+b of a decoded
+// picture a byte at a time, the row written back thresholded, then a float center of
+// mass. Only kept for benchLineDetectors to time rowCenter against
+static int oldFindLine(volatile cameraImage_t *p, int row){
+    int r = row*imageWidth;
+    int sumBright = 0;
+    int sumMass = 0;
+    int sumMassR = 0;
+    int i;
+    for(i=0;i<imageWidth;i++){
+        sumBright = sumBright + p->r[r+i] + p->g[r+i] + p->b[r+i];
+    }
+    int avgBright = sumBright / imageWidth;
+    for(i=0;i<imageWidth;i++){
+        int mass = p->r[r+i] + p->g[r+i] + p->b[r+i];
+        uint8_t v = mass < avgBright ? 0 : 255;
+        p->r[r+i] = v;
+        p->g[r+i] = v;
+        p->b[r+i] = v;
+    }
+    for(i=0;i<imageWidth;i++){
+        int mass = p->r[r+i] + p->g[r+i] + p->b[r+i];
+        sumMass = sumMass + mass;
+        sumMassR = sumMassR + mass*i;
+    }
+    if (sumMass == 0){
+        return -1;
+    }
+    float centerOfMass = (float)sumMassR / sumMass;
+    return (int)(centerOfMass);
+}
+
+// time both line detectors over every row of the frame held by vision, or else the
+// newest one, and print cycles per row. The old findLine is timed on the same frame
+// decoded into the last picture, which is overwritten
+void benchLineDetectors(){
+    volatile uint8_t *raw = frameData(readFrame >= 0 ? readFrame : lastFrame);
+    uint32_t mhz = clock_get_hz(clk_sys)/1000000;
+    int detector;
+    int i;
+    int k;
+    int row;
+    uint32_t start;
+    uint32_t us;
+    for(detector=LINE_CENTROID;detector<=LINE_EDGE;detector++){
+        int count;
+        start = time_us_32();
+        for(k=0;k<10;k++){
+            for(row=0;row<imageHeight;row++){
+                rowLine(detector, raw, row, &count);
+            }
+        }
+        us = time_us_32() - start;
+        printf("%s %d cycles per row\r\n", detector == LINE_EDGE ? "edge" : "centroid", (int)((uint64_t)us*mhz/(10*imageHeight)));
+    }
+    if (frameFormat != FRAME_FORMAT_MASK && imageWidth*imageHeight <= IMAGESIZEX*IMAGESIZEY){
+        volatile cameraImage_t *old = &pictures[NUMPICTURES-1];
+        start = time_us_32();
+        convertFrame(raw, old);
+        uint32_t convertUs = time_us_32() - start;
+        start = time_us_32();
+        for(k=0;k<10;k++){
+            for(row=0;row<imageHeight;row++){
+                oldFindLine(old, row);
+            }
+        }
+        us = time_us_32() - start;
+        printf("old findLine %d cycles per row, after convertFrame %d cycles per row\r\n",
+            (int)((uint64_t)us*mhz/(10*imageHeight)), (int)((uint64_t)convertUs*mhz/imageHeight));
+    }
+    // where the edges were in the bench frame says nothing about the next one
+    for(i=0;i<MAXSIZEY;i++){
+        edgeLast[i] = -1;
+        edgeWidth[i] = -1;
+    }
+}
+
+// center of the above average pixels of a row in 1/256 pixels, count is how many there were
+// works a 32 bit word at a time, 4 Y pixels or 2 RGB565 pixels, rows are word aligned
+int rowCenter(volatile uint8_t *raw, int row, int *count){
+    int n = 0;
+    int sumCol = 0;
+    int sumBright = 0;
+    int i;
+
+    if (frameFormat == FRAME_FORMAT_MASK){
+        // the line pixels are the set bits, popcounts of the word and of the bits whose
+        // column has bit k set add up the count and the column sum
+        volatile uint8_t *p = raw + row*maskRowBytes();
+        int bytes = maskRowBytes();
+        for(i=0;i<bytes;i+=4){
+            uint32_t w = p[i];
+            if (i+1 < bytes) w |= p[i+1] << 8;
+            if (i+2 < bytes) w |= p[i+2] << 16;
+            if (i+3 < bytes) w |= (uint32_t)p[i+3] << 24;
+            uint32_t c = popcount32(w);
+            n = n + c;
+            sumCol = sumCol + c*8*i + popcount32(w & 0xAAAAAAAA) + 2*popcount32(w & 0xCCCCCCCC)
+                + 4*popcount32(w & 0xF0F0F0F0) + 8*popcount32(w & 0xFF00FF00) + 16*popcount32(w & 0xFFFF0000);
+        }
+        *count = n;
+        return n ? (sumCol << 8) / n : -256;
+    }
+    else if (frameFormat == OV7670_COLOR_YUV){
+        uint32_t y[MAXSIZEX/4];
+        volatile uint32_t *p = (volatile uint32_t *)(raw + row*imageWidth);
+        int words = imageWidth/4;
+        uint32_t pairs = 0;
+        // add the bytes in pairs into two 16 bit sums, emptied before 128 words of
+        // 2*255 can overflow them
+        for(i=0;i<words;i++){
+            uint32_t w = p[i];
+            y[i] = w;
+            pairs = pairs + (w & 0x00FF00FF) + ((w >> 8) & 0x00FF00FF);
+            if ((i & 127) == 127){
+                sumBright = sumBright + (pairs & 0xFFFF) + (pairs >> 16);
+                pairs = 0;
+            }
+        }
+        sumBright = sumBright + (pairs & 0xFFFF) + (pairs >> 16);
+        uint32_t avg = (sumBright / imageWidth) * 0x01010101;
+        for(i=0;i<words;i++){
+            uint32_t bits = swarGe(y[i], avg) >> 7; // 1 in each byte that is on
+            uint32_t c = (bits * 0x01010101) >> 24; // how many
+            n = n + c;
+            sumCol = sumCol + c*4*i + ((bits * 0x00010203) >> 24); // plus their column in the word
+        }
+    }
+    else {
+        uint32_t bright[MAXSIZEX/2];
+        volatile uint32_t *p = (volatile uint32_t *)(raw + row*imageWidth*2);
+        int words = imageWidth/2;
+        // r+g+b for both pixels at once, each pixel in its own 16 bits
+        for(i=0;i<words;i++){
+            uint32_t w = p[i];
+            uint32_t m = ((w >> 8) & 0x00F800F8) + ((w >> 3) & 0x00FC00FC) + ((w << 3) & 0x00F800F8);
+            bright[i] = m;
+            sumBright = sumBright + (m & 0xFFFF) + (m >> 16);
+        }
+        uint32_t avg = (sumBright / imageWidth) * 0x00010001;
+        for(i=0;i<words;i++){
+            // both values are under 0x8000, so the top bit survives only if m >= avg
+            uint32_t bits = (((bright[i] | 0x80008000) - avg) & 0x80008000) >> 15;
+            uint32_t c = (bits & 1) + (bits >> 16);
+            n = n + c;
+            sumCol = sumCol + c*2*i + (bits >> 16);
+        }
+    }
+    *count = n;
+    return (sumCol << 8) / n;
+}
+
+// num/den in fixed point with shift fraction bits, without overflowing num << shift
+static int32_t divFixed(int64_t num, int64_t den, int shift){
+    return (int32_t)((num / den) * (1 << shift) + ((num % den) * (1 << shift)) / den);
+}
+
+// fit x = a + b*t + c*t*t through the line centers of LINEROWS rows spread over
+// the image, t is the row minus the middle row, so a is where findLine(height/2)
+// would put it. A row only counts if less than half of it is above average.
+void fitLineRaw(volatile uint8_t *raw, lineFit_t *fit){
+    int32_t t[LINEROWS];
+    int32_t x[LINEROWS]; // 1/256 pixels
+    int n = 0;
+    int k;
+    int64_t S0 = 0, S1 = 0, S2 = 0, S3 = 0, S4 = 0, X0 = 0, X1 = 0, X2 = 0;
+    int32_t a = 0, b = 0, c = 0; // Q8, Q8, Q16
+
+    for(k=0;k<LINEROWS;k++){
+        int row = (2*k+1)*imageHeight/(2*LINEROWS);
+        int count;
+        int center = rowLine(lineDetector, raw, row, &count);
+        if (count == 0 || count*2 > imageWidth){
+            continue; // no clear line in this row
+        }
+        t[n] = row - imageHeight/2;
+        x[n] = center;
+        int64_t tt = (int64_t)t[n]*t[n];
+        S0 += 1;
+        S1 += t[n];
+        S2 += tt;
+        S3 += tt*t[n];
+        S4 += tt*tt;
+        X0 += x[n];
+        X1 += (int64_t)x[n]*t[n];
+        X2 += x[n]*tt;
+        n++;
+    }
+
+    // Cramer's rule on the normal equations, x sums are already Q8
+    int64_t det = S0*(S2*S4 - S3*S3) - S1*(S1*S4 - S3*S2) + S2*(S1*S3 - S2*S2);
+    if (n >= 3 && det != 0){
+        int64_t detA = X0*(S2*S4 - S3*S3) - S1*(X1*S4 - S3*X2) + S2*(X1*S3 - S2*X2);
+        int64_t detB = S0*(X1*S4 - X2*S3) - X0*(S1*S4 - S3*S2) + S2*(S1*X2 - X1*S2);
+        int64_t detC = S0*(S2*X2 - S3*X1) - S1*(S1*X2 - X1*S2) + X0*(S1*S3 - S2*S2);
+        a = divFixed(detA, det, 0);
+        b = divFixed(detB, det, 0);
+        c = divFixed(detC, det, 8);
+    }
+    else if (n >= 2 && S0*S2 - S1*S1 != 0){
+        b = divFixed(S0*X1 - S1*X0, S0*S2 - S1*S1, 0);
+        a = divFixed(X0 - b*S1, S0, 0);
+    }
+    else if (n >= 1){
+        a = divFixed(X0, S0, 0);
+    }
+
+    // confidence falls with the rows missed and the rms error, gone at width/8
+    int64_t sse = 0;
+    for(k=0;k<n;k++){
+        int64_t predicted = a + (int64_t)b*t[k] + (((int64_t)c*t[k]*t[k]) >> 8);
+        int64_t err = x[k] - predicted;
+        sse += (err*err) >> 16; // pixels squared
+    }
+    int32_t maxErr2 = (imageWidth/8)*(imageWidth/8);
+    int32_t err2 = n ? sse/n : maxErr2;
+    if (err2 > maxErr2){
+        err2 = maxErr2;
+    }
+
+    fit->offset = a - ((imageWidth/2) << 8);
+    fit->slope = b;
+    fit->curvature = 2*c;
+    fit->rows = n;
+    fit->confidence = 100*n*(maxErr2 - err2)/(LINEROWS*maxErr2);
+}
+
+// fitLineRaw on the frame held by vision, or else the newest one
+void fitLineFrame(lineFit_t *fit){
+    fitLineRaw(frameData(readFrame >= 0 ? readFrame : lastFrame), fit);
+}
+
+// center of the line between columns lo and hi-1 of a row in 1/256 pixels, -256 if
+// there is none there, count is its width. Only the window is read, with the chosen
+// detector: the pixels above halfway between its darkest and brightest, or the edge
+// pair edgeLine picks in it. A window too flat to hold an edge is all line if it is
+// brighter than the level the line was last found at, so a window that lies on a
+// wide line isn't taken for a lost one.
+static int windowCenter(lineTrack_t *track, volatile uint8_t *raw, int row, int lo, int hi, int *count){
+    uint8_t bright[MAXSIZEX];
+    int min = 255;
+    int max = 0;
+    int i;
+    if (frameFormat == FRAME_FORMAT_MASK){
+        // thresholded already
+        volatile uint8_t *p = raw + row*maskRowBytes();
+        int n = 0;
+        int sumCol = 0;
+        if (lineDetector == LINE_EDGE){
+            return edgeLine(raw, row, lo, hi, count);
+        }
+        for(i=lo;i<hi;i++){
+            if (maskBit(p, i)){
+                n++;
+                sumCol += i;
+            }
+        }
+        *count = n;
+        return n ? (sumCol << 8) / n : -256;
+    }
+    if (frameFormat == OV7670_COLOR_YUV){
+        volatile uint8_t *p = raw + row*imageWidth;
+        for(i=lo;i<hi;i++){
+            bright[i] = p[i];
+        }
+    }
+    else {
+        volatile uint8_t *p = raw + row*imageWidth*2;
+        for(i=lo;i<hi;i++){
+            bright[i] = rgbLuma(p[2*i], p[2*i+1]);
+        }
+    }
+    for(i=lo;i<hi;i++){
+        if (bright[i] < min){
+            min = bright[i];
+        }
+        if (bright[i] > max){
+            max = bright[i];
+        }
+    }
+    *count = 0;
+    if (max - min < edgeThreshold){
+        if (track->valid && min > track->level){
+            *count = hi - lo;
+            return ((lo + hi - 1) << 8) >> 1;
+        }
+        return -256;
+    }
+    int t = (min + max) >> 1;
+    track->level = t;
+    if (lineDetector == LINE_EDGE){
+        return edgeLine(raw, row, lo, hi, count);
+    }
+    int n = 0;
+    int sumCol = 0;
+    for(i=lo;i<hi;i++){
+        if (bright[i] > t){
+            n++;
+            sumCol += i;
+        }
+    }
+    *count = n;
+    return (sumCol << 8) / n;
+}
+
+// forget the line, the next trackLine scans the whole row
+void trackReset(lineTrack_t *track){
+    track->pos = 0;
+    track->vel = 0;
+    track->window = 0;
+    track->lost = 0;
+    track->valid = 0;
+    track->level = 0;
+}
+
+// follow the line in one row from frame to frame, returns its column or -1 if it's lost
+// an alpha-beta filter predicts where the line will be from where it was and how fast
+// it moved, and only the window around the prediction is read, a quarter of the row
+// when locked on. The window doubles for every frame the line is missed or found at
+// its edge, after TRACK_LOST misses whole rows are read again. Lines outside the
+// window, like a crossing or a reflection, are never seen.
+int trackLine(lineTrack_t *track, volatile uint8_t *raw, int row){
+    int count;
+    int lo = 0;
+    int hi = imageWidth;
+    int32_t predicted = track->pos + track->vel;
+    if (track->valid){
+        int half = (imageWidth >> CAM_TRACK_SHIFT) << track->lost;
+        int center = predicted >> 8;
+        lo = center - half;
+        hi = center + half + 1;
+        if (lo < 0){
+            lo = 0;
+        }
+        if (hi > imageWidth){
+            hi = imageWidth;
+        }
+    }
+    track->window = (hi - lo) >> 1;
+    int measured = windowCenter(track, raw, row, lo, hi, &count);
+
+    if (measured < 0 || count*2 > imageWidth){
+        if (!track->valid){
+            return -1;
+        }
+        // coast on the prediction until it has been gone too long
+        track->pos = predicted;
+        track->lost++;
+        if (track->lost >= TRACK_LOST || predicted < 0 || predicted >= (int32_t)(imageWidth << 8)){
+            trackReset(track);
+            return -1;
+        }
+        return track->pos >> 8;
+    }
+    if (!track->valid){
+        track->pos = measured;
+        track->vel = 0;
+        track->valid = 1;
+    }
+    else {
+        // alpha 1/2, beta 1/8
+        int32_t residual = measured - predicted;
+        track->pos = predicted + (residual >> 1);
+        track->vel = track->vel + (residual >> 3);
+    }
+    // a line touching the window edge may carry on past it, look wider next time
+    int first = (measured >> 8) - count/2;
+    int last = (measured >> 8) + count/2;
+    if ((lo > 0 && first <= lo) || (hi < imageWidth && last >= hi-1)){
+        if (track->lost < TRACK_LOST-1){
+            track->lost++;
+        }
+    }
+    else {
+        track->lost = 0;
+    }
+    return track->pos >> 8;
+}
+
+// trackLine on the frame held by vision, or else the newest one
+int trackLineFrame(lineTrack_t *track, int row){
+    return trackLine(track, frameData(readFrame >= 0 ? readFrame : lastFrame), row);
+}
+
+// findLineRaw on the frame held by vision, or else the newest one
+int findLineFrame(int row){
+    return findLineRaw(frameData(readFrame >= 0 ? readFrame : lastFrame), row);
+}
+
+// change the color of a pixel for visualization purposes
+void setPixel(int row, int col, uint8_t r, uint8_t g, uint8_t b){
+    int index = row*imageWidth+col;
+    if (col < 0 || index < 0 || index >= pic->index){
+        return;
+    }
+    pic->r[index] = r;
+    pic->g[index] = g;
+    pic->b[index] = b;
+}
+
+// print out the image to computer
+void printImage(){
+    int i = 0;
+    for(i=0;i<pic->index;i++){
+        printf("%d %d %d %d\r\n", i, pic->r[i], pic->g[i], pic->b[i]);
+    }
+}
+
+// CRC-32 as used by zlib, so the host can check frames with zlib.crc32
+uint32_t crc32(volatile uint8_t *data, uint32_t len){
+    static uint32_t table[256];
+    static uint8_t tableReady = 0;
+    uint32_t i;
+    if (!tableReady){
+        for(i=0;i<256;i++){
+            uint32_t c = i;
+            int k;
+            for(k=0;k<8;k++){
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+        tableReady = 1;
+    }
+    uint32_t crc = 0xFFFFFFFF;
+    for(i=0;i<len;i++){
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+// compressed streaming, only for frames up to IMAGESIZEX*IMAGESIZEY RGB565,
+// bigger frames and frames that do not get smaller are sent raw
+#define STREAMBYTES (IMAGESIZEX*IMAGESIZEY*2)
+#define KEYINTERVAL 30 // frames between delta keyframes
+static uint8_t streamEncoding = FRAME_RAW;
+static uint8_t streamBuf[STREAMBYTES];
+static uint8_t keyBuf[STREAMBYTES]; // last keyframe sent in delta mode
+static uint32_t keySeq = 0;
+static uint32_t keyBytes = 0;
+
+// FRAME_RAW, FRAME_RLE or FRAME_DELTA for sendImage()
+void setStreamEncoding(uint8_t encoding){
+    streamEncoding = encoding;
+    keySeq = 0;
+}
+
+// threshold every row against its average like findLine and store the run
+// lengths, dark run first, a run over 255 is split with an empty run between
+// packed frames are thresholded already, their runs are the bits as they are
+// returns the bytes used, or limit if it would not fit
+uint32_t encodeRle(volatile uint8_t *raw, uint8_t *out, uint32_t limit){
+    uint16_t bright[MAXSIZEX];
+    uint32_t n = 0;
+    uint8_t color = 0;
+    uint32_t run = 0;
+    int row, i;
+    for(row=0;row<imageHeight;row++){
+        volatile uint8_t *p = raw + row*maskRowBytes();
+        int avgBright = 0;
+        if (frameFormat != FRAME_FORMAT_MASK){
+            avgBright = rowBrightness(raw, row, bright) / imageWidth;
+        }
+        for(i=0;i<imageWidth;i++){
+            uint8_t white = (frameFormat == FRAME_FORMAT_MASK) ? maskBit(p, i) : bright[i] >= avgBright;
+            if (white != color){
+                while (run > 255){
+                    if (n + 2 > limit) return limit;
+                    out[n++] = 255;
+                    out[n++] = 0;
+                    run = run - 255;
+                }
+                if (n + 1 > limit) return limit;
+                out[n++] = run;
+                color = white;
+                run = 0;
+            }
+            run++;
+        }
+    }
+    while (run > 255){
+        if (n + 2 > limit) return limit;
+        out[n++] = 255;
+        out[n++] = 0;
+        run = run - 255;
+    }
+    if (n + 1 > limit) return limit;
+    out[n++] = run;
+    return n;
+}
+
+// XOR against the keyframe, then pack: c < 128 is c+1 literal bytes following,
+// c >= 128 is c-126 zero bytes, returns the bytes used, or limit if it would not fit
+uint32_t encodeDelta(volatile uint8_t *raw, uint8_t *key, uint8_t *out, uint32_t limit){
+    uint32_t n = 0;
+    uint32_t i = 0;
+    uint32_t literal = 0; // where the open literal's control byte is, 0 for none
+    uint32_t literalLen = 0;
+    while (i < frameBytes){
+        uint32_t zeros = 0;
+        while (i + zeros < frameBytes && zeros < 129 && raw[i+zeros] == key[i+zeros]){
+            zeros++;
+        }
+        if (zeros >= 2){
+            if (n + 1 > limit) return limit;
+            out[n++] = 126 + zeros;
+            literalLen = 0;
+            i = i + zeros;
+        }
+        else {
+            if (literalLen == 0 || literalLen == 128){
+                if (n + 1 > limit) return limit;
+                literal = n++;
+                literalLen = 0;
+            }
+            if (n + 1 > limit) return limit;
+            out[n++] = raw[i] ^ key[i];
+            literalLen++;
+            out[literal] = literalLen - 1;
+            i++;
+        }
+    }
+    return n;
+}
+
+// \n -> \r\n translation on every stdio driver the project links in, it has to be
+// off in the middle of binary data
+static void translateCrlf(bool on){
+#if LIB_PICO_STDIO_USB
+    stdio_set_translate_crlf(&stdio_usb, on);
+#endif
+#if LIB_PICO_STDIO_UART
+    stdio_set_translate_crlf(&stdio_uart, on);
+#endif
+}
+
+// send the raw frame held by vision, or else the newest one, to the computer
+// as one binary block, see frameHeader_t and HW12/Camera/python/camframe.py
+void sendImage(){
+    int f = readFrame >= 0 ? readFrame : lastFrame;
+    volatile uint8_t *raw = frameData(f);
+    volatile uint8_t *payload = raw;
+    frameHeader_t h;
+    h.magic = FRAMEMAGIC;
+    h.seq = frameInfo[f].seq;
+    h.time = frameInfo[f].end;
+    h.width = imageWidth;
+    h.height = imageHeight;
+    h.format = frameFormat;
+    h.encoding = FRAME_RAW;
+    h.ref = 0;
+    h.length = frameBytes;
+
+    if (frameBytes <= STREAMBYTES && streamEncoding == FRAME_RLE){
+        uint32_t n = encodeRle(raw, streamBuf, frameBytes);
+        if (n < frameBytes){
+            h.encoding = FRAME_RLE;
+            h.length = n;
+            payload = streamBuf;
+        }
+    }
+    else if (frameBytes <= STREAMBYTES && streamEncoding == FRAME_DELTA){
+        uint32_t n = frameBytes;
+        if (keySeq != 0 && keyBytes == frameBytes && h.seq != keySeq && h.seq - keySeq < KEYINTERVAL){
+            n = encodeDelta(raw, keyBuf, streamBuf, frameBytes);
+        }
+        if (n < frameBytes){
+            h.encoding = FRAME_DELTA;
+            h.ref = h.seq - keySeq;
+            h.length = n;
+            payload = streamBuf;
+        }
+        else {
+            // sent raw, so it becomes the keyframe
+            uint32_t i;
+            for(i=0;i<frameBytes;i++){
+                keyBuf[i] = raw[i];
+            }
+            keySeq = h.seq;
+            keyBytes = frameBytes;
+        }
+    }
+    h.crc = crc32(payload, h.length);
+
+    translateCrlf(false);
+    fwrite(&h, sizeof(h), 1, stdout);
+    fwrite((const void *)payload, 1, h.length, stdout);
+    fflush(stdout);
+    translateCrlf(PICO_STDIO_DEFAULT_CRLF);
+}
+
+// every buffer cam.c allocates, all static so the linker places them
+#define CAM_RAM_BYTES (sizeof(cameraData) + sizeof(pictures) + sizeof(lineMask) + sizeof(streamBuf) + sizeof(keyBuf) + sizeof(binRows) + sizeof(binSum) + sizeof(packHist))
+_Static_assert(CAM_RAM_BYTES <= CAM_RAM_BUDGET, "camera buffers don't fit CAM_RAM_BUDGET, lower MAXSIZEX/CAM_SIZE or CAM_POOL_BYTES");
+
+// bytes of RAM the camera buffers take
+uint32_t getCameraRam(){
+    return CAM_RAM_BYTES;
+}
+
+// print where the camera's RAM goes, camera_ram_report() in CMakeLists.txt
+// prints the same for the whole program when it links
+void printRamBudget(){
+    printf("raw frames %d (%d of %d bytes)\r\n", (int)sizeof(cameraData), (int)numFrames, (int)frameBytes);
+    printf("pictures %d\r\n", (int)sizeof(pictures));
+    printf("line mask %d\r\n", (int)sizeof(lineMask));
+    printf("stream %d\r\n", (int)(sizeof(streamBuf) + sizeof(keyBuf)));
+    printf("binning %d\r\n", (int)(sizeof(binRows) + sizeof(binSum)));
+    printf("packing %d\r\n", (int)sizeof(packHist));
+    printf("camera total %d of %d\r\n", (int)CAM_RAM_BYTES, (int)CAM_RAM_BUDGET);
+}
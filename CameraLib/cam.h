@@ -0,0 +1,346 @@
+#ifndef CAM_h
+#define CAM_h
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "ov7670.h"
+
+// I2C defines
+#define I2C_PORT i2c1
+#define I2C_SDA 14
+#define I2C_SCL 15
+
+// pins
+// D0-D7 on GP0-GP7
+#define D0 0
+#define D1 1
+#define D2 2
+#define D3 3
+#define D4 4
+#define D5 5
+#define D6 6
+#define D7 7
+// VS on GP8
+#define VS 8
+// HS on GP9
+#define HS 9
+// MCLK on GP10, set 50% 25MHz PWM
+#define MCLK 10
+// PCLK on GP11
+#define PCLK 11
+// RST to GP12
+#define RST 12
+// PWDN to GP13
+#define PWDN 13
+
+// compile time configuration, a project sets these with target_compile_definitions
+
+// capture with PIO+DMA, set to 0 to take a GPIO interrupt on every PCLK instead
+#ifndef CAM_USE_PIO
+#define CAM_USE_PIO 1
+#endif
+
+// size at boot as an OV7670_size: 1 = 320x240, 2 = 160x120, 3 = 80x60, 4 = 40x30
+#ifndef CAM_SIZE
+#define CAM_SIZE 3
+#endif
+
+// pixel format at boot, OV7670_COLOR_RGB or OV7670_COLOR_YUV
+#ifndef CAM_FORMAT
+#define CAM_FORMAT OV7670_COLOR_RGB
+#endif
+
+// capture binning at boot: 1 = off, 2 or 4 averages that many pixels square into
+// one luminance byte as the rows arrive, see setBinning()
+#ifndef CAM_BIN
+#define CAM_BIN 1
+#endif
+#if CAM_BIN != 1 && CAM_BIN != 2 && CAM_BIN != 4
+#error "CAM_BIN must be 1, 2 or 4"
+#endif
+
+// 1 to threshold frames into 1 bit per pixel while capturing, see setPackedFrames()
+#ifndef CAM_PACK
+#define CAM_PACK 0
+#endif
+#define FRAME_FORMAT_MASK 2 // frame format of packed frames, next to OV7670_COLOR_RGB and _YUV
+
+// 1 to lock the size, format, binning and packing to CAM_SIZE, CAM_FORMAT, CAM_BIN and
+// CAM_PACK, they become constants so the capture and decode loops are compiled for
+// exactly that frame, and setResolution/setPixelFormat/setBinning/setPackedFrames
+// refuse anything else
+#ifndef CAM_FIXED
+#define CAM_FIXED 0
+#endif
+
+// 1 to read back every init register when bringing up a new board, doubles the
+// I2C traffic, and registers the auto exposure, gain and white balance loops own
+// may have moved on by the time they are read
+#ifndef CAM_VERIFY_INIT
+#define CAM_VERIFY_INIT 0
+#endif
+#define CAM_READY_MS 100 // longest wait for the camera to answer after a reset
+
+// OV7670_flush sends neighbouring registers in one I2C transfer, only for
+// sensors that auto increment the register address on writes
+#ifndef CAM_SCCB_BURST
+#define CAM_SCCB_BURST 0
+#endif
+
+// fast mode, see setFastMode()
+#ifndef CAM_FAST_EXPOSURE
+#define CAM_FAST_EXPOSURE 64 // rows, about 4.5ms at 27fps
+#endif
+#ifndef CAM_FAST_GAIN
+#define CAM_FAST_GAIN 0x30 // 4x
+#endif
+// 1 lets fast mode clock the sensor at 18.75MHz * 4 / 2 = 37.5MHz, about 45fps,
+// well past the 24MHz the OV7670 is rated for. It may give noisy or torn frames or
+// stop sending them, and runs hotter, so check measureFramePeriod() and getShortFrames()
+// on the sensor in the robot before relying on it. PIO only, 0 keeps it at 22.5MHz
+#ifndef CAM_OVERCLOCK
+#define CAM_OVERCLOCK 0
+#endif
+
+// RGB565 example:
+// https://blog.usedbytes.com/2022/02/pico-pio-camera/
+
+void init_camera_pins();
+void init_camera();
+int setResolution(OV7670_size size);
+uint32_t getImageWidth();
+uint32_t getImageHeight();
+float getFrameRate();
+void setFixedExposure(uint16_t rows, uint16_t gain);
+void setAutoExposure();
+void setFastMode(uint32_t on);
+uint32_t measureFramePeriod(int frames);
+uint32_t getBringUpTime();
+void setPixelFormat(OV7670_colorspace format);
+OV7670_colorspace getPixelFormat();
+int setBinning(int bin);
+int getBinning();
+int setPackedFrames(int on);
+int getPackedFrames();
+void setSaveImage(uint32_t);
+void setContinuous(uint32_t);
+int acquireFrame();
+void releaseFrame();
+uint32_t getFrameSeq(int frame);
+uint32_t getFrameTime(int frame);
+int findFrame(uint32_t seq);
+uint32_t getFrameCount();
+uint32_t getDroppedFrames();
+uint32_t getSaveImage();
+uint32_t getHSCount();
+uint32_t getPixelCount();
+#if !CAM_USE_PIO
+void captureEvent(uint gpio, uint8_t data);
+#endif
+void convertImage();
+void printImage();
+void sendImage();
+void setStreamEncoding(uint8_t encoding);
+uint32_t crc32(volatile uint8_t *data, uint32_t len);
+uint32_t encodeRle(volatile uint8_t *raw, uint8_t *out, uint32_t limit);
+uint32_t encodeDelta(volatile uint8_t *raw, uint8_t *key, uint8_t *out, uint32_t limit);
+int findLine(int row);
+int findLineRaw(volatile uint8_t *raw, int row);
+int findLineFrame(int row);
+void setPixel(int row, int col, uint8_t r, uint8_t g, uint8_t b);
+
+// all the camera's buffers live in cam.c, these hand them out
+int setNumFrames(int n);
+int getNumFrames();
+uint32_t getFrameBytes();
+volatile uint8_t *getFrameBuffer(int frame);
+uint32_t getCameraRam();
+void printRamBudget();
+
+// sensor size at boot, also the largest image a decoded picture can hold
+#define IMAGESIZEX (640 >> CAM_SIZE)
+#define IMAGESIZEY (480 >> CAM_SIZE)
+// vision reads rows a word at a time, see binFits() in cam.c
+#if (IMAGESIZEX/CAM_BIN) % 4 != 0
+#error "CAM_SIZE width / CAM_BIN must be a multiple of 4 pixels, use a larger CAM_SIZE or less binning"
+#endif
+#ifndef NUMFRAMES
+#define NUMFRAMES 3 // capture one while vision works on another, one spare
+#endif
+// largest size setResolution accepts as an OV7670_size, CAM_SIZE unless a project
+// asks for more, 1 for 320x240 costs a 150KB pool
+#ifndef CAM_MAX_SIZE
+#define CAM_MAX_SIZE CAM_SIZE
+#endif
+#if CAM_MAX_SIZE > CAM_SIZE || (CAM_FIXED && CAM_MAX_SIZE != CAM_SIZE)
+#error "CAM_MAX_SIZE must be CAM_SIZE or a bigger image, and CAM_SIZE with CAM_FIXED"
+#endif
+#if CAM_FIXED
+// largest size setResolution accepts
+#define MAXSIZEX IMAGESIZEX
+#define MAXSIZEY IMAGESIZEY
+// binned frames are Y only
+#define CAM_BYTES_PER_PIXEL (CAM_FORMAT == OV7670_COLOR_YUV || CAM_BIN > 1 ? 1 : 2)
+#if CAM_PACK
+#define CAM_FRAME_BYTES (((IMAGESIZEX/CAM_BIN + 7)/8)*(IMAGESIZEY/CAM_BIN))
+#else
+#define CAM_FRAME_BYTES ((IMAGESIZEX/CAM_BIN)*(IMAGESIZEY/CAM_BIN)*CAM_BYTES_PER_PIXEL)
+#endif
+// raw frame storage, exactly NUMFRAMES frames
+#ifndef CAM_POOL_BYTES
+#define CAM_POOL_BYTES (CAM_FRAME_BYTES*NUMFRAMES)
+#endif
+#else
+#define MAXSIZEX (640 >> CAM_MAX_SIZE)
+#define MAXSIZEY (480 >> CAM_MAX_SIZE)
+// raw frame storage, NUMFRAMES RGB565 frames of the boot size, and room for at
+// least one of the largest
+#ifndef CAM_POOL_BYTES
+#define CAM_POOL_BYTES (MAXSIZEX*MAXSIZEY > IMAGESIZEX*IMAGESIZEY*NUMFRAMES ? MAXSIZEX*MAXSIZEY*2 : IMAGESIZEX*IMAGESIZEY*2*NUMFRAMES)
+#endif
+#endif
+// everything cam.c allocates must fit in this, checked when it compiles
+#ifndef CAM_RAM_BUDGET
+#define CAM_RAM_BUDGET (256*1024)
+#endif
+
+// brightness histograms, built while decoding: Y, or (r+g+b)/4 for RGB565
+#define HISTBINS 256
+#define HISTBANDS 4 // horizontal bands, each gets its own threshold for uneven light
+#ifndef CAM_OTSU_SEPARATION
+#define CAM_OTSU_SEPARATION 24 // levels between the dark and bright means for a band to be split
+#endif
+
+// frame signature, a coarse brightness grid of HISTBANDS rows by SIGZONES columns
+// sampled as each frame finishes, see frameChanged()
+#define SIGZONES 8
+#ifndef CAM_CHANGE_THRESHOLD
+#define CAM_CHANGE_THRESHOLD 12 // levels one grid cell must move for the frame to count as changed
+#endif
+
+typedef struct cameraImage{
+    uint32_t index;
+    uint8_t r[IMAGESIZEX*IMAGESIZEY];
+    uint8_t g[IMAGESIZEX*IMAGESIZEY];
+    uint8_t b[IMAGESIZEX*IMAGESIZEY];
+    uint16_t hist[HISTBANDS][HISTBINS];
+    uint8_t threshold[HISTBANDS]; // Otsu threshold of each band, brighter is line
+} cameraImage_t;
+#define NUMPICTURES 2 // decoded by core1 while core0 uses the other
+
+volatile cameraImage_t *getPicture();
+
+// what capture saw of a frame in the ring, see getFrameInfo()
+typedef struct frameInfo{
+    uint32_t seq; // frame sequence number
+    uint32_t start; // time_us_32 at the VS it started on
+    uint32_t end; // time_us_32 when it finished
+    uint32_t bytes; // bytes stored
+    uint16_t rows; // rows counted
+    uint8_t complete; // every row and byte arrived, 0 means steer on something else
+    uint8_t sig[HISTBANDS][SIGZONES]; // signature, average brightness of each grid cell
+} frameInfo_t;
+
+// a decoded frame handed from core1 to core0
+typedef struct cameraFrame{
+    uint32_t seq; // frame sequence number
+    uint32_t time; // time_us_32 when decoding finished
+    uint8_t picture; // which decoded picture it is in
+} cameraFrame_t;
+
+// binary frame sent by sendImage(), little endian, followed by length bytes of pixels:
+// RGB565 low byte first, or one Y byte per pixel
+#define FRAMEMAGIC 0x3146564F // "OVF1"
+#define FRAME_RAW 0 // encoding, payload is the frame as captured
+#define FRAME_RLE 1 // thresholded rows as run lengths, see encodeRle()
+#define FRAME_DELTA 2 // XOR against an earlier raw frame, packed, see encodeDelta()
+typedef struct __attribute__((packed)) frameHeader{
+    uint32_t magic;
+    uint32_t seq; // frame sequence number
+    uint32_t time; // time_us_32 when the frame finished
+    uint16_t width;
+    uint16_t height;
+    uint8_t format; // OV7670_colorspace
+    uint8_t encoding;
+    uint16_t ref; // FRAME_DELTA: how many frames back the raw keyframe is
+    uint32_t length; // payload bytes
+    uint32_t crc; // CRC-32 of the payload
+} frameHeader_t;
+
+// line position, direction and bend from several rows, see fitLineRaw()
+#define LINEROWS 8 // rows sampled per frame
+
+// how findLineRaw, fitLineRaw and trackLine find the line in a row, see setLineDetector()
+#define LINE_CENTROID 0 // center of the pixels brighter than the row average
+#define LINE_EDGE 1 // pair a rising and a falling brightness edge, for glossy floors and shadows
+#ifndef CAM_EDGE_THRESHOLD
+#define CAM_EDGE_THRESHOLD 24 // brightness step across 2 pixels that counts as an edge
+#endif
+typedef struct lineFit{
+    int32_t offset; // line x at the middle row minus the image center, 1/256 pixels
+    int32_t slope; // change in x per row down the image, 1/256 pixels
+    int32_t curvature; // change in slope per row, 1/65536 pixels
+    uint8_t rows; // rows the line was found in
+    uint8_t confidence; // 0-100
+} lineFit_t;
+
+// line tracker, follows the line in one row from frame to frame, see trackLine()
+#ifndef CAM_TRACK_SHIFT
+#define CAM_TRACK_SHIFT 3 // search imageWidth >> CAM_TRACK_SHIFT either side of the prediction
+#endif
+#define TRACK_LOST 4 // frames without the line before going back to whole rows
+typedef struct lineTrack{
+    int32_t pos; // 1/256 pixels
+    int32_t vel; // 1/256 pixels per frame
+    uint16_t window; // half width searched last time, pixels
+    uint8_t lost; // frames in a row it wasn't found, the window doubles each one
+    uint8_t valid; // 0 until the line has been seen
+    uint8_t level; // brightness halfway between the floor and the line where it was last found
+} lineTrack_t;
+
+// frame health
+void getFrameInfo(int frame, frameInfo_t *info);
+int frameComplete(int frame);
+uint32_t getShortFrames();
+uint32_t getLongFrames();
+int frameChanged(int frame);
+void setChangeThreshold(uint8_t levels);
+uint32_t getSkippedFrames();
+void convertFrame(volatile uint8_t *raw, volatile cameraImage_t *out);
+uint8_t otsuThreshold(volatile uint16_t *hist, uint8_t previous);
+int getBand(int row);
+void thresholdPicture();
+const uint8_t *getLineMask();
+int rowCenter(volatile uint8_t *raw, int row, int *count);
+int rowEdges(volatile uint8_t *raw, int row, int *count);
+void setLineDetector(int detector);
+int getLineDetector();
+void setEdgeThreshold(uint8_t step);
+void benchLineDetectors();
+void fitLineRaw(volatile uint8_t *raw, lineFit_t *fit);
+void fitLineFrame(lineFit_t *fit);
+void trackReset(lineTrack_t *track);
+int trackLine(lineTrack_t *track, volatile uint8_t *raw, int row);
+int trackLineFrame(lineTrack_t *track, int row);
+// dual core mode
+void startCameraCore1();
+void waitPicture(cameraFrame_t *frame);
+uint32_t getCoreLoad(uint core);
+// I2C functions
+void OV7670_write_register(uint8_t reg, uint8_t value);
+uint8_t OV7670_read_register(uint8_t reg);
+int OV7670_read_checked(uint8_t reg, uint8_t *value);
+int OV7670_wait_ready(uint32_t timeout_ms);
+int OV7670_write_table(const uint8_t table[][2]);
+uint8_t OV7670_get_register(uint8_t reg);
+void OV7670_update_register(uint8_t reg, uint8_t mask, uint8_t value);
+void OV7670_set_register(uint8_t reg, uint8_t mask, uint8_t value);
+void OV7670_flush();
+void OV7670_set_exposure(uint16_t rows);
+void OV7670_set_gain(uint16_t gain);
+void OV7670_test_pattern(OV7670_pattern pattern);
+
+#endif
\ No newline at end of file
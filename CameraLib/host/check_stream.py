@@ -0,0 +1,31 @@
+# decode stream.bin from test_stream with camframe.Stream, as the viewers do, and
+# compare every frame with the one test_stream sent, from frames.bin
+#   python3 check_stream.py <dir with stream.bin and frames.bin>
+import os
+import sys
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..', '..', 'HW12', 'Camera', 'python'))
+import camframe
+
+W = 80
+H = 60
+FRAMEBYTES = W * H * 2
+
+folder = sys.argv[1] if len(sys.argv) > 1 else '.'
+with open(os.path.join(folder, 'frames.bin'), 'rb') as f:
+    sent = f.read()
+count = len(sent) // FRAMEBYTES
+
+bad = 0
+with open(os.path.join(folder, 'stream.bin'), 'rb') as f:
+    stream = camframe.Stream(f)
+    for k in range(count):
+        frame = stream.read()
+        if frame is None or frame.payload != sent[k * FRAMEBYTES:(k + 1) * FRAMEBYTES]:
+            print('frame %d did not decode' % k)
+            bad += 1
+
+if bad:
+    print('check_stream: %d of %d frames wrong' % (bad, count))
+    sys.exit(1)
+print('check_stream: %d frames ok' % count)
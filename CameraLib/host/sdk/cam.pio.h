@@ -0,0 +1,14 @@
+// stand-in for the header pioasm makes from ../../cam.pio, the programs
+// themselves are modelled in ../sim.c
+#ifndef HOST_CAM_PIO_h
+#define HOST_CAM_PIO_h
+
+#include "hardware/pio.h"
+
+extern const pio_program_t cam_capture_program;
+extern const pio_program_t cam_capture_luma_program;
+
+void cam_capture_program_init(PIO pio, uint sm, uint offset, uint pin_base);
+void cam_capture_luma_program_init(PIO pio, uint sm, uint offset, uint pin_base);
+
+#endif
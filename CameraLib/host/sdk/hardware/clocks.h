@@ -0,0 +1,10 @@
+#ifndef HOST_HARDWARE_CLOCKS_h
+#define HOST_HARDWARE_CLOCKS_h
+
+#include "pico/stdlib.h"
+
+#define clk_sys 5
+
+uint32_t clock_get_hz(int clock);
+
+#endif
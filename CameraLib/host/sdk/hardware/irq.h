@@ -0,0 +1,13 @@
+#ifndef HOST_HARDWARE_IRQ_h
+#define HOST_HARDWARE_IRQ_h
+
+#include "pico/stdlib.h"
+
+#define DMA_IRQ_0 10
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef HOST_HARDWARE_PIO_h
+#define HOST_HARDWARE_PIO_h
+
+#include "pico/stdlib.h"
+
+// one PIO block with one state machine, modelled in ../sim.c
+typedef struct pio_hw{
+    volatile uint32_t txf[4];
+    volatile uint32_t rxf[4];
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+extern pio_hw_t sim_pio0;
+#define pio0 (&sim_pio0)
+
+typedef struct pio_sm_config{
+    uint32_t unused;
+} pio_sm_config;
+
+typedef struct pio_program{
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+uint pio_encode_jmp(uint addr);
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_HARDWARE_PWM_h
+#define HOST_HARDWARE_PWM_h
+
+#include "pico/stdlib.h"
+
+uint pwm_gpio_to_slice_num(uint gpio);
+void pwm_set_clkdiv(uint slice, float div);
+void pwm_set_wrap(uint slice, uint16_t wrap);
+void pwm_set_enabled(uint slice, bool enabled);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_HARDWARE_SYNC_h
+#define HOST_HARDWARE_SYNC_h
+
+#include "pico/stdlib.h"
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+#endif
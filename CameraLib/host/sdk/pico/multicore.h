@@ -0,0 +1,10 @@
+#ifndef HOST_PICO_MULTICORE_h
+#define HOST_PICO_MULTICORE_h
+
+#include "pico/stdlib.h"
+
+// the host has one core, core1 never runs
+void multicore_launch_core1(void (*entry)(void));
+uint get_core_num(void);
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef HOST_PICO_STDIO_UART_h
+#define HOST_PICO_STDIO_UART_h
+
+#include "pico/stdio_usb.h"
+
+extern stdio_driver_t stdio_uart;
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef HOST_PICO_STDIO_USB_h
+#define HOST_PICO_STDIO_USB_h
+
+#include "pico/stdlib.h"
+
+typedef struct stdio_driver{
+    int unused;
+} stdio_driver_t;
+extern stdio_driver_t stdio_usb;
+
+void stdio_set_translate_crlf(stdio_driver_t *driver, bool translate);
+
+#endif
@@ -0,0 +1,38 @@
+// host stand-in for the pico SDK, just what CameraLib uses, see ../sim.c
+#ifndef HOST_PICO_STDLIB_h
+#define HOST_PICO_STDLIB_h
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -1
+#define PICO_STDIO_DEFAULT_CRLF 1
+
+#define GPIO_IN 0
+#define GPIO_OUT 1
+#define GPIO_FUNC_I2C 3
+#define GPIO_FUNC_PWM 4
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define count_of(a) (sizeof(a)/sizeof((a)[0]))
+#define tight_loop_contents() do {} while (0)
+
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+absolute_time_t get_absolute_time(void);
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+static inline void __dmb(void){}
+static inline void __compiler_memory_barrier(void){}
+
+#endif
@@ -0,0 +1,541 @@
+#include <string.h>
+#include <time.h>
+#include "sim.h"
+#include "hardware/gpio.h"
+#include "hardware/i2c.h"
+#include "hardware/pwm.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "pico/multicore.h"
+#include "pico/stdio_usb.h"
+#include "pico/stdio_uart.h"
+#include "cam.pio.h"
+#include "cam.h"
+
+int simFailures = 0;
+
+// time
+uint64_t simTimeUs = 1000;
+
+void simAdvance(uint32_t us){
+    simTimeUs += us;
+}
+
+uint64_t simNowNs(){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec*1000000000ull + t.tv_nsec;
+}
+
+uint32_t simRand(){
+    static uint32_t seed = 12345;
+    seed = seed*1103515245u + 12345u;
+    return seed >> 8;
+}
+
+void sleep_ms(uint32_t ms){
+    simTimeUs += (uint64_t)ms*1000;
+}
+
+void sleep_us(uint64_t us){
+    simTimeUs += us;
+}
+
+uint64_t time_us_64(void){
+    return simTimeUs++;
+}
+
+uint32_t time_us_32(void){
+    return (uint32_t)time_us_64();
+}
+
+absolute_time_t get_absolute_time(void){
+    return time_us_64();
+}
+
+bool stdio_init_all(void){
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us){
+    simTimeUs += timeout_us;
+    return PICO_ERROR_TIMEOUT;
+}
+
+stdio_driver_t stdio_usb;
+stdio_driver_t stdio_uart;
+
+void stdio_set_translate_crlf(stdio_driver_t *driver, bool translate){
+}
+
+uint32_t clock_get_hz(int clock){
+    return 150000000;
+}
+
+uint32_t save_and_disable_interrupts(void){
+    return 0;
+}
+
+void restore_interrupts(uint32_t status){
+}
+
+void multicore_launch_core1(void (*entry)(void)){
+}
+
+uint get_core_num(void){
+    return 0;
+}
+
+// camera registers, a 1 byte write sets the address for the next read
+static i2c_inst_t *simI2c;
+i2c_inst_t *i2c1 = (i2c_inst_t *)&simI2c;
+uint8_t simRegs[256] = {[OV7670_REG_PID] = OV7670_PID, [OV7670_REG_VER] = OV7670_VER};
+static uint8_t simRegAddr = 0;
+uint32_t simI2cWrites = 0;
+simI2cWrite_t simI2cLog[SIMI2CLOG];
+uint32_t simI2cReads = 0;
+
+void simI2cClear(){
+    simI2cWrites = 0;
+    simI2cReads = 0;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate){
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop){
+    size_t i;
+    simRegAddr = src[0];
+    if (len > 1){
+        if (simI2cWrites < SIMI2CLOG){
+            simI2cLog[simI2cWrites].reg = src[0];
+            simI2cLog[simI2cWrites].count = len - 1;
+        }
+        simI2cWrites++;
+    }
+    for(i=1;i<len;i++){
+        if (simRegAddr == OV7670_REG_COM7 && (src[i] & OV7670_COM7_RESET)){
+            int r;
+            for(r=0;r<256;r++){
+                if (r != OV7670_REG_PID && r != OV7670_REG_VER){
+                    simRegs[r] = 0;
+                }
+            }
+        }
+        else if (simRegAddr != OV7670_REG_PID && simRegAddr != OV7670_REG_VER){
+            simRegs[simRegAddr] = src[i];
+        }
+        simRegAddr++;
+    }
+    return len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop){
+    size_t i;
+    for(i=0;i<len;i++){
+        dst[i] = simRegs[simRegAddr++];
+        simI2cReads++;
+    }
+    return len;
+}
+
+uint pwm_gpio_to_slice_num(uint gpio){
+    return (gpio >> 1) & 7;
+}
+
+void pwm_set_clkdiv(uint slice, float div){
+}
+
+void pwm_set_wrap(uint slice, uint16_t wrap){
+}
+
+void pwm_set_enabled(uint slice, bool enabled){
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level){
+}
+
+// pins, and the one GPIO interrupt callback the SDK keeps per core
+static uint32_t pins = 0;
+static uint32_t irqEvents[32];
+static gpio_irq_callback_t irqCallback = NULL;
+static void pioRun();
+
+void gpio_init(uint gpio){
+}
+
+void gpio_set_dir(uint gpio, bool out){
+}
+
+void gpio_put(uint gpio, bool value){
+}
+
+bool gpio_get(uint gpio){
+    return (pins >> gpio) & 1;
+}
+
+uint32_t gpio_get_all(void){
+    return pins;
+}
+
+void gpio_set_function(uint gpio, int fn){
+}
+
+void gpio_pull_up(uint gpio){
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled){
+    if (enabled){
+        irqEvents[gpio] |= events;
+    }
+    else {
+        irqEvents[gpio] &= ~events;
+    }
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback){
+    gpio_set_irq_enabled(gpio, events, enabled);
+    irqCallback = callback;
+}
+
+void simPin(uint gpio, int level){
+    uint32_t bit = 1u << gpio;
+    if (((pins & bit) != 0) == (level != 0)){
+        return;
+    }
+    pins = level ? pins | bit : pins & ~bit;
+    uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if (irqCallback != NULL && (irqEvents[gpio] & event)){
+        irqCallback(gpio, event);
+    }
+    pioRun();
+}
+
+// interrupts
+static irq_handler_t dmaIrqHandler = NULL;
+static uint8_t dmaIrqEnabled = 0;
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler){
+    if (num == DMA_IRQ_0){
+        dmaIrqHandler = handler;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled){
+    if (num == DMA_IRQ_0){
+        dmaIrqEnabled = enabled;
+    }
+}
+
+// DMA, one channel reading 32 bit words from the RX FIFO
+static volatile uint8_t *dmaWrite = NULL;
+static uint32_t dmaCount = 0;
+static uint8_t dmaBusy = 0;
+static uint8_t dmaChannelIrq = 0;
+uint32_t simDmaIrqs = 0;
+static uint32_t rxFifo[8];
+static int rxCount = 0;
+
+int dma_claim_unused_channel(bool required){
+    return 0;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel){
+    dma_channel_config c = {0};
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, int size){
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr){
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr){
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq){
+}
+
+// move words from the RX FIFO while the channel has a count, the handler runs
+// as soon as the count reaches 0, like the interrupt would
+static void dmaRun(){
+    while (dmaBusy && rxCount > 0){
+        uint32_t word = rxFifo[0];
+        rxCount--;
+        memmove(rxFifo, rxFifo + 1, rxCount*sizeof(uint32_t));
+        memcpy((uint8_t *)dmaWrite, &word, 4);
+        dmaWrite += 4;
+        dmaCount--;
+        if (dmaCount == 0){
+            dmaBusy = 0;
+            simDmaIrqs++;
+            if (dmaChannelIrq && dmaIrqEnabled && dmaIrqHandler != NULL){
+                dmaIrqHandler();
+            }
+        }
+    }
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, uint transfer_count, bool trigger){
+    dmaWrite = write_addr;
+    dmaCount = transfer_count;
+    dmaBusy = trigger && transfer_count > 0;
+    dmaRun();
+}
+
+void dma_channel_transfer_to_buffer_now(uint channel, volatile void *write_addr, uint32_t transfer_count){
+    dmaWrite = write_addr;
+    dmaCount = transfer_count;
+    dmaBusy = transfer_count > 0;
+    dmaRun();
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled){
+    dmaChannelIrq = enabled;
+}
+
+void dma_channel_acknowledge_irq0(uint channel){
+}
+
+void dma_channel_abort(uint channel){
+    dmaBusy = 0;
+}
+
+// PIO, the state machine running cam_capture or cam_capture_luma, one state per
+// instruction that can wait, see ../cam.pio
+pio_hw_t sim_pio0;
+const pio_program_t cam_capture_program;
+const pio_program_t cam_capture_luma_program;
+static const pio_program_t *smProgram = NULL;
+static uint8_t smEnabled = 0;
+static uint8_t smRunning = 0;
+static uint32_t txFifo[4];
+static int txCount = 0;
+static uint32_t smX, smY, smOsr, smIsr, smShift;
+uint32_t simPioWords = 0;
+uint32_t simPioStalls = 0;
+enum {
+    SM_PULL_ROWS, // pull block, mov y osr
+    SM_PULL_BYTES, // pull block
+    SM_VS_HIGH, // wait 1 pin PIN_VS
+    SM_VS_LOW, // wait 0 pin PIN_VS
+    SM_ROW, // mov x osr
+    SM_HS_HIGH, // wait 1 pin PIN_HS
+    SM_PCLK_HIGH, // wait 1 pin PIN_PCLK, in pins 8
+    SM_PCLK_LOW, // wait 0 pin PIN_PCLK
+    SM_SKIP_HIGH, // luma: wait 1 pin PIN_PCLK
+    SM_SKIP_LOW, // luma: wait 0 pin PIN_PCLK
+    SM_NEXT_BYTE, // jmp x-- byte
+    SM_HS_LOW, // wait 0 pin PIN_HS, jmp y-- row
+};
+static int smState = SM_PULL_ROWS;
+
+static uint32_t txPop(){
+    uint32_t v = txFifo[0];
+    txCount--;
+    memmove(txFifo, txFifo + 1, txCount*sizeof(uint32_t));
+    return v;
+}
+
+// run until the state machine waits on a pin or a FIFO, the DMA handler can restart it
+// from inside, so each state is set before anything that may call back into cam.c
+static void pioRun(){
+    if (smRunning){
+        return;
+    }
+    smRunning = 1;
+    while (smEnabled){
+        int state = smState;
+        if (state == SM_PULL_ROWS || state == SM_PULL_BYTES){
+            if (txCount == 0){
+                break;
+            }
+            if (state == SM_PULL_ROWS){
+                smY = txPop();
+                smState = SM_PULL_BYTES;
+            }
+            else {
+                smOsr = txPop();
+                smState = SM_VS_HIGH;
+            }
+        }
+        else if (state == SM_VS_HIGH || state == SM_VS_LOW){
+            if (gpio_get(VS) != (state == SM_VS_HIGH)){
+                break;
+            }
+            smState = state == SM_VS_HIGH ? SM_VS_LOW : SM_ROW;
+        }
+        else if (state == SM_ROW){
+            smX = smOsr;
+            smState = SM_HS_HIGH;
+        }
+        else if (state == SM_HS_HIGH){
+            if (!gpio_get(HS)){
+                break;
+            }
+            smState = SM_PCLK_HIGH;
+        }
+        else if (state == SM_PCLK_HIGH){
+            if (!gpio_get(PCLK)){
+                break;
+            }
+            if (smShift == 24 && rxCount == 8){
+                simPioStalls++; // autopush stalls until there is room
+                break;
+            }
+            smIsr = (smIsr >> 8) | ((pins & 0xFF) << 24);
+            smShift += 8;
+            smState = SM_PCLK_LOW;
+            if (smShift == 32){
+                rxFifo[rxCount++] = smIsr;
+                smIsr = 0;
+                smShift = 0;
+                simPioWords++;
+                dmaRun();
+            }
+        }
+        else if (state == SM_PCLK_LOW || state == SM_SKIP_LOW){
+            if (gpio_get(PCLK)){
+                break;
+            }
+            smState = (state == SM_PCLK_LOW && smProgram == &cam_capture_luma_program) ? SM_SKIP_HIGH : SM_NEXT_BYTE;
+        }
+        else if (state == SM_SKIP_HIGH){
+            if (!gpio_get(PCLK)){
+                break;
+            }
+            smState = SM_SKIP_LOW;
+        }
+        else if (state == SM_NEXT_BYTE){
+            if (smX != 0){
+                smX--;
+                smState = SM_PCLK_HIGH;
+            }
+            else {
+                smState = SM_HS_LOW;
+            }
+        }
+        else if (state == SM_HS_LOW){
+            if (gpio_get(HS)){
+                break;
+            }
+            if (smY != 0){
+                smY--;
+                smState = SM_ROW;
+            }
+            else {
+                smState = SM_PULL_ROWS; // .wrap
+            }
+        }
+    }
+    smRunning = 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program){
+    smProgram = program;
+    return 0;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint offset){
+}
+
+int pio_claim_unused_sm(PIO pio, bool required){
+    return 0;
+}
+
+void cam_capture_program_init(PIO pio, uint sm, uint offset, uint pin_base){
+    smProgram = &cam_capture_program;
+}
+
+void cam_capture_luma_program_init(PIO pio, uint sm, uint offset, uint pin_base){
+    smProgram = &cam_capture_luma_program;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled){
+    smEnabled = enabled;
+    pioRun();
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm){
+    txCount = 0;
+    rxCount = 0;
+}
+
+void pio_sm_restart(PIO pio, uint sm){
+    smIsr = 0;
+    smShift = 0;
+}
+
+// only ever a jmp to the start of the program
+void pio_sm_exec(PIO pio, uint sm, uint instr){
+    smState = SM_PULL_ROWS;
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data){
+    if (txCount < 4){
+        txFifo[txCount++] = data;
+    }
+    pioRun();
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx){
+    return 0;
+}
+
+uint pio_encode_jmp(uint addr){
+    return addr;
+}
+
+// the sensor
+uint32_t simBlankPclk = 4;
+uint32_t simJitterUs = 0;
+uint32_t simRowUs = 130;
+
+void simVsync(){
+    simPin(VS, 1);
+    simAdvance(3*simRowUs);
+    simPin(VS, 0);
+    simAdvance(17*simRowUs);
+}
+
+void simPclk(uint8_t data){
+    pins = (pins & ~0xFFu) | data;
+    simPin(PCLK, 1);
+    simPin(PCLK, 0);
+}
+
+void simRow(const uint8_t *data, int bytes){
+    int i;
+    simAdvance(simJitterUs ? simRand() % (simJitterUs + 1) : 0);
+    simPin(HS, 1);
+    for(i=0;i<bytes;i++){
+        simPclk(data[i]);
+    }
+    simPin(HS, 0);
+    for(i=0;i<simBlankPclk;i++){
+        simPclk(0);
+    }
+    simAdvance(simRowUs);
+}
+
+void simFrame(const uint8_t *data, int rowBytes, int rows){
+    int i;
+    simVsync();
+    for(i=0;i<rows;i++){
+        simRow(data + i*rowBytes, rowBytes);
+    }
+}
+
+int simResult(const char *name){
+    if (simFailures){
+        printf("%s: %d checks failed\n", name, simFailures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
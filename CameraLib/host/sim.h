@@ -0,0 +1,57 @@
+#ifndef SIM_h
+#define SIM_h
+
+// host stand-in for the pico and the OV7670, so cam.c builds and runs on a PC:
+// the SDK calls cam.c makes go to sim.c, which keeps the pin levels, a fake clock,
+// the camera's registers, and a model of the cam.pio state machine and its DMA channel
+// a test drives the pins like the sensor would, cam.c sees the same edges as on the robot
+
+#include "pico/stdlib.h"
+
+// camera registers as written over I2C, PID and VER answer like an OV7670, a COM7
+// reset puts the rest back to 0
+extern uint8_t simRegs[256];
+// I2C traffic: transfers that wrote registers, the first SIMI2CLOG of them with
+// the register they started at and how many they wrote, and register reads
+#define SIMI2CLOG 64
+typedef struct simI2cWrite{
+    uint8_t reg;
+    uint8_t count;
+} simI2cWrite_t;
+extern uint32_t simI2cWrites;
+extern simI2cWrite_t simI2cLog[SIMI2CLOG];
+extern uint32_t simI2cReads;
+void simI2cClear(); // start counting from 0
+
+// fake time_us_64, moves on by itself a little on every read so polling loops end
+extern uint64_t simTimeUs;
+void simAdvance(uint32_t us);
+// real time for benchmarks
+uint64_t simNowNs();
+// repeatable random numbers
+uint32_t simRand();
+
+// set a pin, fires the GPIO interrupt callback for that edge and steps the PIO model
+void simPin(uint gpio, int level);
+
+// the sensor's signal, the defaults are an 80x60 RGB565 frame
+extern uint32_t simBlankPclk; // PCLK pulses while HS is low after each row
+extern uint32_t simJitterUs; // up to this many us added before each row
+extern uint32_t simRowUs; // time per row
+void simVsync(); // VS high then low, a new frame starts
+void simPclk(uint8_t data); // one byte on D0-D7 clocked on PCLK rising
+void simRow(const uint8_t *data, int bytes); // HS high, a PCLK per byte, HS low
+void simFrame(const uint8_t *data, int rowBytes, int rows); // simVsync then rows
+
+// PIO model
+extern uint32_t simPioWords; // words the state machine pushed
+extern uint32_t simPioStalls; // words it could not push, RX FIFO full and no DMA
+extern uint32_t simDmaIrqs; // DMA transfers that finished
+
+// test helpers
+extern int simFailures;
+#define CHECK(cond) do { if (!(cond)){ printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); simFailures++; } } while (0)
+#define CHECK_EQ(a, b) do { long long a_ = (long long)(a); long long b_ = (long long)(b); if (a_ != b_){ printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #a, a_, b_); simFailures++; } } while (0)
+int simResult(const char *name);
+
+#endif
@@ -0,0 +1,213 @@
+// interrupt backend: a simulated sensor drives captureEvent through gpio_callback,
+// clean frames and the faults a loose wire or a wrong window gives, then how long
+// capture, convert and findLine take per frame on this machine
+#include <string.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define ROWBYTES (W*2)
+#define FRAMEBYTES (ROWBYTES*H)
+
+// a frame plus rows past the end for the long frame and long row faults
+static uint8_t image[FRAMEBYTES + 8*ROWBYTES];
+
+// dark floor with a white line at col, the first byte numbers the frame
+static void makeFrame(int col, uint8_t n){
+    int row;
+    int i;
+    for(row=0;row<H+8;row++){
+        for(i=0;i<W;i++){
+            uint16_t px = (i >= col - 3 && i <= col + 3) ? 0xFFFF : 0x2104;
+            image[row*ROWBYTES + 2*i] = px & 0xFF;
+            image[row*ROWBYTES + 2*i + 1] = px >> 8;
+        }
+    }
+    image[0] = n;
+}
+
+// rows rows, row bad gets badBytes bytes instead of a whole row
+static void sendFrame(int rows, int bad, int badBytes){
+    int row;
+    simVsync();
+    for(row=0;row<rows;row++){
+        simRow(image + row*ROWBYTES, row == bad ? badBytes : ROWBYTES);
+    }
+}
+
+// take the frame capture just finished and check what it recorded
+static void checkFrame(int complete, int rows, int bytes, int same){
+    frameInfo_t info;
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f < 0){
+        return;
+    }
+    getFrameInfo(f, &info);
+    CHECK_EQ(info.complete, complete);
+    CHECK_EQ(frameComplete(f), complete);
+    CHECK_EQ(info.rows, rows);
+    CHECK_EQ(info.bytes, bytes);
+    CHECK_EQ(getHSCount(), rows);
+    CHECK_EQ(getPixelCount(), bytes);
+    CHECK(info.end - info.start >= (uint32_t)rows*simRowUs);
+    if (same){
+        CHECK(memcmp((uint8_t *)getFrameBuffer(f), image, FRAMEBYTES) == 0);
+    }
+    releaseFrame();
+}
+
+static void testFaults(){
+    uint32_t shortFrames = getShortFrames();
+
+    // clean frame, one shot
+    makeFrame(40, 1);
+    setSaveImage(1);
+    sendFrame(H, -1, 0);
+    CHECK_EQ(getSaveImage(), 0);
+    checkFrame(1, H, FRAMEBYTES, 1);
+    CHECK_EQ(getShortFrames(), shortFrames);
+    CHECK_EQ(getLongFrames(), 0);
+
+    // more rows than the window, the frame is fine but counts as long
+    makeFrame(20, 2);
+    setSaveImage(1);
+    sendFrame(H + 4, -1, 0);
+    checkFrame(1, H, FRAMEBYTES, 1);
+    CHECK_EQ(getLongFrames(), 1);
+    CHECK_EQ(getShortFrames(), shortFrames);
+
+    // a PCLK went missing, every row after it is out by a byte and the frame
+    // only ends at the next VS
+    makeFrame(60, 3);
+    setSaveImage(1);
+    sendFrame(H, 10, ROWBYTES - 1);
+    simVsync();
+    checkFrame(0, H, FRAMEBYTES - 1, 0);
+    CHECK_EQ(getShortFrames(), shortFrames + 1);
+
+    // a row cut short by an early HS fall
+    setSaveImage(1);
+    sendFrame(H, 20, 100);
+    simVsync();
+    checkFrame(0, H, FRAMEBYTES - (ROWBYTES - 100), 0);
+    CHECK_EQ(getShortFrames(), shortFrames + 2);
+
+    // PCLKs past the end of a row are dropped, the frame is still whole
+    makeFrame(30, 4);
+    setSaveImage(1);
+    sendFrame(H, 30, ROWBYTES + 10);
+    checkFrame(1, H, FRAMEBYTES, 1);
+    CHECK_EQ(getShortFrames(), shortFrames + 2);
+
+    // VS before all the rows
+    setSaveImage(1);
+    sendFrame(40, -1, 0);
+    simVsync();
+    checkFrame(0, 40, 40*ROWBYTES, 0);
+    CHECK_EQ(getShortFrames(), shortFrames + 3);
+    CHECK_EQ(getLongFrames(), 1);
+}
+
+static void testJitter(){
+    int n;
+    uint32_t shortFrames = getShortFrames();
+    uint32_t dropped = getDroppedFrames();
+    simJitterUs = 200;
+    setContinuous(1);
+    for(n=0;n<20;n++){
+        makeFrame(10 + 3*n, n);
+        simBlankPclk = simRand() % 16;
+        sendFrame(H, -1, 0);
+        checkFrame(1, H, FRAMEBYTES, 1);
+    }
+    CHECK_EQ(getShortFrames(), shortFrames);
+    CHECK_EQ(getDroppedFrames(), dropped);
+    CHECK(getFrameRate() > 0);
+    setContinuous(0);
+    simJitterUs = 0;
+    simBlankPclk = 4;
+}
+
+// frames vision never took are counted as dropped, it gets the newest
+static void testDropped(){
+    int n;
+    uint32_t dropped = getDroppedFrames();
+    uint32_t count = getFrameCount();
+    setContinuous(1);
+    for(n=0;n<4;n++){
+        makeFrame(40, 100 + n);
+        sendFrame(H, -1, 0);
+    }
+    CHECK_EQ(getFrameCount(), count + 4);
+    CHECK_EQ(getDroppedFrames(), dropped + 3);
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f >= 0){
+        CHECK_EQ(getFrameSeq(f), count + 4);
+        CHECK_EQ(getFrameBuffer(f)[0], 103);
+        releaseFrame();
+    }
+    setContinuous(0);
+}
+
+static void bench(){
+    int n;
+    int row;
+    int frames = 200;
+    uint64_t t;
+    int sum = 0;
+    makeFrame(50, 0);
+    setContinuous(1);
+    t = simNowNs();
+    for(n=0;n<frames;n++){
+        sendFrame(H, -1, 0);
+    }
+    double capture = (simNowNs() - t) / 1000.0 / frames;
+    setContinuous(0);
+    acquireFrame();
+    t = simNowNs();
+    for(n=0;n<frames;n++){
+        convertImage();
+    }
+    double convert = (simNowNs() - t) / 1000.0 / frames;
+    t = simNowNs();
+    for(n=0;n<frames;n++){
+        for(row=0;row<H;row++){
+            sum += findLine(row);
+        }
+    }
+    double find = (simNowNs() - t) / 1000.0 / frames;
+    CHECK_EQ(sum, frames*H*50);
+    releaseFrame();
+    printf("per %dx%d frame: capture %.1fus (%d interrupts), convertImage %.1fus, findLine all rows %.1fus\n",
+        W, H, capture, 1 + H*(1 + ROWBYTES + simBlankPclk), convert, find);
+}
+
+// the pool holds NUMFRAMES boot size frames, bigger sizes only with CAM_MAX_SIZE
+static void testSizes(){
+    printf("camera RAM %d bytes\n", (int)getCameraRam());
+    CHECK_EQ(getNumFrames(), NUMFRAMES);
+    CHECK_EQ(setResolution(OV7670_SIZE_DIV4), CAM_MAX_SIZE <= OV7670_SIZE_DIV4);
+    CHECK_EQ(setResolution(OV7670_SIZE_DIV2), CAM_MAX_SIZE <= OV7670_SIZE_DIV2);
+    if (CAM_MAX_SIZE <= OV7670_SIZE_DIV2){
+        CHECK_EQ(getImageWidth(), 320);
+        CHECK_EQ(getNumFrames(), 1);
+    }
+    CHECK_EQ(setResolution(OV7670_SIZE_DIV16), 1);
+    CHECK_EQ(getImageWidth(), 40);
+    CHECK_EQ(setResolution(CAM_SIZE), 1);
+    CHECK_EQ(getImageWidth(), W);
+    CHECK_EQ(getNumFrames(), NUMFRAMES);
+}
+
+int main(){
+    init_camera_pins();
+    testSizes();
+    testFaults();
+    testJitter();
+    testDropped();
+    bench();
+    return simResult("capture");
+}
@@ -0,0 +1,162 @@
+// rowEdges against rowCenter on made up lines in every frame format, all the way
+// out to the sides, and what benchLineDetectors leaves behind for the loop after it
+#include <string.h>
+#include <stdlib.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define ROWBYTES (W*2)
+#define WHITE 0xFFFF
+#define FLOOR 0x4208
+
+static uint8_t image[ROWBYTES*H];
+
+// floor with a white line over columns [from, to) in every row, two lines if from2 < to2
+static void makeFrame(int from, int to, int from2, int to2){
+    int i;
+    for(i=0;i<W*H;i++){
+        int x = i % W;
+        uint16_t px = ((x >= from && x < to) || (x >= from2 && x < to2)) ? WHITE : FLOOR;
+        image[2*i] = px & 0xFF;
+        image[2*i + 1] = px >> 8;
+    }
+}
+
+// the frame as if it had just been captured
+static volatile uint8_t *useFrame(){
+    volatile uint8_t *raw = getFrameBuffer(0);
+    memcpy((uint8_t *)raw, image, sizeof(image));
+    return raw;
+}
+
+// a white line over columns [from, to) of every row straight into the frame buffer
+// in whatever format it holds, a bit per pixel packed or else Y or RGB565
+static volatile uint8_t *fillFrame(int from, int to){
+    volatile uint8_t *raw = getFrameBuffer(0);
+    int format = getPackedFrames() ? FRAME_FORMAT_MASK : getPixelFormat();
+    int row;
+    int i;
+    for(row=0;row<H;row++){
+        for(i=0;i<W;i++){
+            int on = i >= from && i < to;
+            if (format == FRAME_FORMAT_MASK){
+                if (on){
+                    raw[row*(W/8) + i/8] |= 1 << (i & 7);
+                }
+                else {
+                    raw[row*(W/8) + i/8] &= ~(1 << (i & 7));
+                }
+            }
+            else if (format == OV7670_COLOR_YUV){
+                raw[row*W + i] = on ? 230 : 60;
+            }
+            else {
+                uint16_t px = on ? WHITE : FLOOR;
+                raw[2*(row*W + i)] = px & 0xFF;
+                raw[2*(row*W + i) + 1] = px >> 8;
+            }
+        }
+    }
+    return raw;
+}
+
+// both detectors put a line anywhere across the row, touching the sides too, on its
+// center, and nothing on a row that is half bright
+static void testBorders(const char *name){
+    int widths[3] = {1, 3, 6};
+    int w;
+    int from;
+    int count;
+    int bad = 0;
+    for(w=0;w<3;w++){
+        for(from=0;from+widths[w]<=W;from++){
+            volatile uint8_t *raw = fillFrame(from, from + widths[w]);
+            int want = from*256 + (widths[w] - 1)*128;
+            int edges = rowEdges(raw, H/2, &count);
+            int center = rowCenter(raw, H/2, &count);
+            if (abs(edges - want) > 128 || abs(center - want) > 128){
+                if (bad == 0){
+                    printf("%s line over %d-%d: rowEdges %d rowCenter %d, want %d\n", name, from, from + widths[w] - 1, edges, center, want);
+                }
+                bad++;
+            }
+        }
+    }
+    CHECK_EQ(bad, 0);
+    // the floor to one side, not a line
+    volatile uint8_t *raw = fillFrame(0, W/2 + 5);
+    CHECK_EQ(rowEdges(raw, H/2, &count), -256);
+    raw = fillFrame(W/2 - 5, W);
+    CHECK_EQ(rowEdges(raw, H/2, &count), -256);
+}
+
+// of two lines near where the line was, the one as wide as it was
+static void testWidth(){
+    int count;
+    setLineDetector(LINE_EDGE);
+    makeFrame(37, 43, 0, 0);
+    volatile uint8_t *raw = useFrame();
+    CHECK_EQ(rowEdges(raw, H/2, &count) >> 8, 39);
+    CHECK_EQ(count, 6);
+    // a 20 pixel patch of glare right where it was, a 6 pixel line 13 pixels over
+    makeFrame(28, 48, 50, 56);
+    useFrame();
+    CHECK_EQ(rowEdges(raw, H/2, &count) >> 8, 52);
+    CHECK_EQ(count, 6);
+}
+
+// the bench must not leave the loop its frame or where the line was in it
+static void testBench(){
+    int row;
+    int count;
+    setLineDetector(LINE_EDGE);
+
+    // with no hint rowEdges takes the line nearer the middle
+    makeFrame(57, 63, 7, 13);
+    volatile uint8_t *raw = useFrame();
+    CHECK_EQ(rowEdges(raw, H/2, &count) >> 8, 59);
+    makeFrame(57, 63, 0, 0);
+    useFrame();
+    CHECK_EQ(rowEdges(raw, H/2, &count) >> 8, 59);
+
+    // the bench frame has its line at col 10, captured like camera.c does it
+    makeFrame(7, 13, 0, 0);
+    setSaveImage(1);
+    simFrame(image, ROWBYTES, H);
+    CHECK(!getSaveImage());
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    benchLineDetectors();
+    releaseFrame();
+
+    // after it both lines are as far from a hint as they were before
+    makeFrame(57, 63, 7, 13);
+    raw = useFrame();
+    for(row=0;row<H;row++){
+        CHECK_EQ(rowEdges(raw, row, &count) >> 8, 59);
+    }
+
+    // and the loop's first frame is a new one
+    setContinuous(1);
+    CHECK_EQ(acquireFrame(), -1);
+    simFrame(image, ROWBYTES, H);
+    f = acquireFrame();
+    CHECK(f >= 0);
+    CHECK(getFrameSeq(f) > 1);
+    releaseFrame();
+    setContinuous(0);
+}
+
+int main(){
+    init_camera_pins();
+    testBench();
+    testWidth();
+    testBorders("RGB565");
+    setPixelFormat(OV7670_COLOR_YUV);
+    testBorders("YUV");
+    CHECK_EQ(setPackedFrames(1), 1);
+    testBorders("packed");
+    return simResult("edges");
+}
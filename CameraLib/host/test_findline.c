@@ -0,0 +1,165 @@
+// findLineRaw straight from the raw RGB565 frame against convertImage + findLine:
+// both must put the line in the same place, then the time each takes per frame
+// frames are made up, or pass a recording from HW12/Camera/python/recorder.py
+// to run on real ones:  test_findline run1.ovr
+#include <string.h>
+#include <stdlib.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define FRAMEBYTES (W*H*2)
+#define MAXFRAMES 64
+
+static uint8_t frames[MAXFRAMES][FRAMEBYTES];
+static int lineCol[MAXFRAMES]; // where the line is in each row, -1 for a recording
+static int numFrames = 0;
+
+static uint16_t rgb565(int r, int g, int b){
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+// a 6 pixel white line on a floor that gets darker down the image, a little noise
+static void makeFrame(uint8_t *frame, int col){
+    int row;
+    int i;
+    for(row=0;row<H;row++){
+        for(i=0;i<W;i++){
+            int v = (i >= col - 3 && i < col + 3) ? 230 : 40 + (H - row)/2;
+            v += simRand() % 9 - 4;
+            uint16_t px = rgb565(v, v, v);
+            frame[2*(row*W + i)] = px & 0xFF;
+            frame[2*(row*W + i) + 1] = px >> 8;
+        }
+    }
+}
+
+// the 80x60 RGB565 raw frames of an OVR1 file, see recorder.py
+static int loadRecording(const char *path){
+    FILE *f = fopen(path, "rb");
+    uint8_t header[36];
+    int i;
+    int n = 0;
+    if (f == NULL || fread(header, 1, sizeof(header), f) != sizeof(header) || memcmp(header, "OVR1", 4) != 0){
+        printf("%s is not a recording\n", path);
+        return 0;
+    }
+    uint32_t count;
+    uint64_t indexOffset;
+    memcpy(&count, header + 8, 4);
+    memcpy(&indexOffset, header + 12, 8);
+    for(i=0;i<count && n<MAXFRAMES;i++){
+        uint8_t entry[36];
+        uint64_t offset;
+        uint32_t length;
+        uint16_t width, height;
+        fseek(f, indexOffset + i*sizeof(entry), SEEK_SET);
+        if (fread(entry, 1, sizeof(entry), f) != sizeof(entry)){
+            break;
+        }
+        memcpy(&offset, entry, 8);
+        memcpy(&length, entry + 8, 4);
+        memcpy(&width, entry + 28, 2);
+        memcpy(&height, entry + 30, 2);
+        if (width != W || height != H || entry[32] != OV7670_COLOR_RGB || length != FRAMEBYTES){
+            continue;
+        }
+        fseek(f, offset, SEEK_SET);
+        if (fread(frames[n], 1, FRAMEBYTES, f) == FRAMEBYTES){
+            lineCol[n] = -1;
+            n++;
+        }
+    }
+    fclose(f);
+    printf("%d frames from %s\n", n, path);
+    return n;
+}
+
+// the frame convertImage and findLineRaw work on
+static volatile uint8_t *useFrame(int n){
+    volatile uint8_t *raw = getFrameBuffer(0);
+    memcpy((uint8_t *)raw, frames[n], FRAMEBYTES);
+    return raw;
+}
+
+// both find the made up line in every row, and agree on real frames
+static void testAgree(){
+    int n;
+    int row;
+    int differ = 0;
+    int rows = 0;
+    for(n=0;n<numFrames;n++){
+        volatile uint8_t *raw = useFrame(n);
+        convertImage();
+        for(row=0;row<H;row++){
+            int a = findLine(row);
+            int b = findLineRaw(raw, row);
+            if (lineCol[n] >= 0){
+                CHECK(abs(a - lineCol[n]) <= 1);
+                CHECK(abs(b - lineCol[n]) <= 1);
+            }
+            differ += abs(a - b) > 1;
+            rows++;
+        }
+    }
+    printf("findLine and findLineRaw more than a pixel apart in %d of %d rows\n", differ, rows);
+    if (lineCol[0] >= 0){
+        CHECK_EQ(differ, 0);
+    }
+}
+
+// one row as the robot steers on, and LINEROWS rows as fitLineRaw samples
+static void bench(){
+    int rowsList[2] = {1, LINEROWS};
+    int r;
+    int n;
+    int k;
+    int loops = 2000;
+    int sum = 0;
+    for(r=0;r<2;r++){
+        int rows = rowsList[r];
+        uint64_t t = simNowNs();
+        for(n=0;n<loops;n++){
+            useFrame(n % numFrames);
+            convertImage();
+            for(k=0;k<rows;k++){
+                sum += findLine((2*k+1)*H/(2*rows));
+            }
+        }
+        double convert = (simNowNs() - t) / 1000.0 / loops;
+        t = simNowNs();
+        for(n=0;n<loops;n++){
+            volatile uint8_t *raw = useFrame(n % numFrames);
+            for(k=0;k<rows;k++){
+                sum += findLineRaw(raw, (2*k+1)*H/(2*rows));
+            }
+        }
+        double raw = (simNowNs() - t) / 1000.0 / loops;
+        // copying the frame in is in both, take it out
+        t = simNowNs();
+        for(n=0;n<loops;n++){
+            useFrame(n % numFrames);
+        }
+        double copy = (simNowNs() - t) / 1000.0 / loops;
+        printf("%d row%s per frame: convertImage+findLine %.2fus, findLineRaw %.2fus, %.0fx\n",
+            rows, rows > 1 ? "s" : "", convert - copy, raw - copy, (convert - copy)/(raw - copy));
+    }
+    CHECK(sum != 0);
+}
+
+int main(int argc, char **argv){
+    init_camera_pins();
+    if (argc > 1){
+        numFrames = loadRecording(argv[1]);
+    }
+    if (numFrames == 0){
+        for(numFrames=0;numFrames<32;numFrames++){
+            lineCol[numFrames] = 8 + numFrames*2;
+            makeFrame(frames[numFrames], lineCol[numFrames]);
+        }
+    }
+    testAgree();
+    bench();
+    return simResult("findline");
+}
@@ -0,0 +1,136 @@
+// one configuration built twice, generic and with CAM_FIXED=1: the generic build
+// writes what it captured, decoded and found and how long that took, the fixed build
+// must get exactly the same out of the same frames and prints how much faster it was
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W IMAGESIZEX // what the sensor sends
+#define H IMAGESIZEY
+#define ROWBYTES (W*2) // RGB565 or YUV422
+#define LINECOL (W*3/5) // where the line is in the sensor image
+#define FRAMES 100
+
+static uint8_t image[ROWBYTES*H];
+static cameraImage_t picture;
+
+typedef struct result{
+    uint32_t frameSum; // of the last frame captured
+    uint32_t pictureSum; // of what convertFrame made of it
+    uint32_t lineSum; // of findLineRaw over every row
+    double capture; // us per frame
+    double convert;
+    double find;
+} result_t;
+
+static uint32_t checksum(uint32_t sum, volatile const uint8_t *p, int bytes){
+    int i;
+    for(i=0;i<bytes;i++){
+        sum = (sum ^ p[i]) * 16777619;
+    }
+    return sum;
+}
+
+// a noisy floor with a 7 pixel white line around LINECOL
+static void makeFrame(){
+    int i;
+    for(i=0;i<W*H;i++){
+        int x = i % W;
+        int v = (x >= LINECOL - 3 && x <= LINECOL + 3) ? 220 : 50 + simRand() % 6;
+        if (CAM_FORMAT == OV7670_COLOR_YUV){
+            image[2*i] = v;
+            image[2*i + 1] = 0x80;
+        }
+        else {
+            uint16_t px = ((v >> 3) << 11) | ((v >> 2) << 5) | (v >> 3);
+            image[2*i] = px & 0xFF;
+            image[2*i + 1] = px >> 8;
+        }
+    }
+}
+
+static void bench(result_t *r){
+    int n;
+    int row;
+    int width = getImageWidth();
+    int height = getImageHeight();
+    uint64_t t;
+    makeFrame();
+    setContinuous(1);
+    t = simNowNs();
+    for(n=0;n<FRAMES;n++){
+        simFrame(image, ROWBYTES, H);
+    }
+    r->capture = (simNowNs() - t) / 1000.0 / FRAMES;
+    setContinuous(0);
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f < 0){
+        return;
+    }
+    CHECK_EQ(frameComplete(f), 1);
+    volatile uint8_t *raw = getFrameBuffer(f);
+    r->frameSum = checksum(2166136261u, raw, getFrameBytes());
+
+    t = simNowNs();
+    for(n=0;n<FRAMES;n++){
+        convertFrame(raw, &picture);
+    }
+    r->convert = (simNowNs() - t) / 1000.0 / FRAMES;
+    r->pictureSum = checksum(2166136261u, picture.r, width*height);
+    r->pictureSum = checksum(r->pictureSum, picture.g, width*height);
+    r->pictureSum = checksum(r->pictureSum, picture.b, width*height);
+
+    int bad = 0;
+    r->lineSum = 0;
+    t = simNowNs();
+    for(n=0;n<FRAMES;n++){
+        for(row=0;row<height;row++){
+            int col = findLineRaw(raw, row);
+            r->lineSum += col;
+            bad += abs(col - LINECOL/CAM_BIN) > 1;
+        }
+    }
+    r->find = (simNowNs() - t) / 1000.0 / FRAMES;
+    CHECK_EQ(bad, 0);
+    releaseFrame();
+    printf("per %dx%d frame: capture %.1fus, convertFrame %.1fus, findLineRaw all rows %.1fus\n",
+        width, height, r->capture, r->convert, r->find);
+}
+
+int main(){
+    result_t r = {0};
+    char name[64];
+    init_camera_pins();
+    CHECK_EQ(getImageWidth(), W/CAM_BIN);
+    CHECK_EQ(getPixelFormat(), CAM_FORMAT);
+    CHECK_EQ(getPackedFrames(), CAM_PACK);
+    bench(&r);
+    snprintf(name, sizeof(name), "generic_%d_%d_%d_%d.txt", CAM_SIZE, CAM_FORMAT, CAM_BIN, CAM_PACK);
+#if CAM_FIXED
+    result_t g;
+    FILE *file = fopen(name, "r");
+    if (!file){
+        printf("no %s, run the generic build first to compare with\n", name);
+        return simResult("fixed");
+    }
+    CHECK_EQ(fscanf(file, "%u %u %u %lf %lf %lf", &g.frameSum, &g.pictureSum, &g.lineSum, &g.capture, &g.convert, &g.find), 6);
+    fclose(file);
+    CHECK_EQ(r.frameSum, g.frameSum);
+    CHECK_EQ(r.pictureSum, g.pictureSum);
+    CHECK_EQ(r.lineSum, g.lineSum);
+    printf("CAM_FIXED against generic: capture %.2fx, convertFrame %.2fx, findLineRaw %.2fx\n",
+        g.capture/r.capture, g.convert/r.convert, g.find/r.find);
+    return simResult("fixed");
+#else
+    FILE *file = fopen(name, "w");
+    CHECK(file != NULL);
+    if (file){
+        fprintf(file, "%u %u %u %f %f %f\n", r.frameSum, r.pictureSum, r.lineSum, r.capture, r.convert, r.find);
+        fclose(file);
+    }
+    return simResult("generic");
+#endif
+}
@@ -0,0 +1,88 @@
+// frameChanged on frames captured through the simulated sensor: the same frame
+// again or with a little noise is skipped and counted, a moved line or a change
+// past the threshold is not, at full size, binned and packed
+#include <string.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define ROWBYTES (W*2)
+
+static uint8_t image[ROWBYTES*H];
+
+// a white line over columns [col, col+6) on a gray floor of level floor, each pixel
+// moved up to +-noise levels
+static void makeFrame(int col, int floor, int noise){
+    int i;
+    for(i=0;i<W*H;i++){
+        int x = i % W;
+        int v = (x >= col && x < col + 6) ? 240 : floor;
+        if (noise){
+            v += simRand() % (2*noise + 1) - noise;
+        }
+        uint16_t px = ((v >> 3) << 11) | ((v >> 2) << 5) | (v >> 3);
+        image[2*i] = px & 0xFF;
+        image[2*i + 1] = px >> 8;
+    }
+}
+
+// capture image and ask frameChanged about it
+static int capture(){
+    setSaveImage(1);
+    simFrame(image, ROWBYTES, H);
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f < 0){
+        return -1;
+    }
+    CHECK_EQ(frameComplete(f), 1);
+    int changed = frameChanged(f);
+    releaseFrame();
+    return changed;
+}
+
+static void testGate(const char *name, int packed){
+    uint32_t skipped = getSkippedFrames();
+    printf("%s\n", name);
+    makeFrame(20, 80, 4);
+    CHECK_EQ(capture(), 1); // nothing to compare with
+    if (packed){
+        CHECK_EQ(capture(), 1); // the first packed frame is empty, no thresholds yet
+    }
+    CHECK_EQ(capture(), 0); // the same frame
+    CHECK_EQ(getSkippedFrames(), skipped + 1);
+    makeFrame(20, 80, 4);
+    CHECK_EQ(capture(), 0); // the same view, different noise
+    CHECK_EQ(getSkippedFrames(), skipped + 2);
+    makeFrame(50, 80, 0);
+    CHECK_EQ(capture(), 1); // the line moved
+    CHECK_EQ(getSkippedFrames(), skipped + 2);
+    CHECK_EQ(capture(), 0);
+    CHECK_EQ(getSkippedFrames(), skipped + 3);
+    if (!packed){
+        // the floor getting darker a little at a time is measured from the last frame
+        // vision worked on, so it counts once it has moved past the threshold
+        makeFrame(50, 72, 0);
+        CHECK_EQ(capture(), 0);
+        makeFrame(50, 64, 0);
+        CHECK_EQ(capture(), 1);
+        CHECK_EQ(getSkippedFrames(), skipped + 4);
+    }
+    // 0 turns the gate off
+    setChangeThreshold(0);
+    CHECK_EQ(capture(), 1);
+    setChangeThreshold(CAM_CHANGE_THRESHOLD);
+    CHECK_EQ(capture(), 0);
+}
+
+int main(){
+    init_camera_pins();
+    testGate("RGB565", 0);
+    CHECK_EQ(setBinning(2), 1);
+    testGate("binned", 0);
+    CHECK_EQ(setBinning(1), 1);
+    CHECK_EQ(setPackedFrames(1), 1);
+    testGate("packed", 1);
+    return simResult("gate");
+}
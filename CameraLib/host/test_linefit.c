@@ -0,0 +1,122 @@
+// fitLineRaw on made up straight and curved lines, with both detectors: how far
+// the offset, slope and curvature come out from the line that was drawn, and what
+// a fit costs per frame on this machine
+#include <string.h>
+#include <math.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+
+typedef struct lineCase{
+    const char *name;
+    double x0; // x at the middle row, pixels
+    double slope; // pixels per row
+    double curve; // second derivative, pixels per row per row
+    int noise; // +- brightness
+    int gap; // rows from the top with no line
+} lineCase_t;
+
+static const lineCase_t cases[] = {
+    {"centered", 40, 0, 0, 0, 0},
+    {"offset left", 22.5, 0, 0, 0, 0},
+    {"slope right", 40, 0.3, 0, 0, 0},
+    {"slope left", 45, -0.45, 0, 0, 0},
+    {"curve", 40, 0, 0.02, 0, 0},
+    {"curve and slope", 35, 0.25, -0.015, 0, 0},
+    {"noisy", 42, 0.2, 0.01, 8, 0},
+    {"top missing", 38, -0.2, 0, 0, 20},
+};
+
+static uint16_t rgb565(int r, int g, int b){
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+// a 7 pixel white line centered on x(t) = x0 + slope*t + curve*t*t/2, t = row - H/2
+static void makeFrame(volatile uint8_t *frame, const lineCase_t *c){
+    int row;
+    int i;
+    for(row=0;row<H;row++){
+        double t = row - H/2;
+        double x = c->x0 + c->slope*t + c->curve*t*t/2;
+        for(i=0;i<W;i++){
+            int v = (fabs(i - x) <= 3.5 && row >= c->gap) ? 220 : 50;
+            if (c->noise){
+                v += simRand() % (2*c->noise + 1) - c->noise;
+            }
+            uint16_t px = rgb565(v, v, v);
+            frame[2*(row*W + i)] = px & 0xFF;
+            frame[2*(row*W + i) + 1] = px >> 8;
+        }
+    }
+}
+
+static void testCases(int detector){
+    int n;
+    lineFit_t fit;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    setLineDetector(detector);
+    printf("%s detector          offset err  slope err  curve err  rows  confidence\n", detector == LINE_EDGE ? "edge    " : "centroid");
+    for(n=0;n<count_of(cases);n++){
+        const lineCase_t *c = &cases[n];
+        makeFrame(raw, c);
+        fitLineRaw(raw, &fit);
+        double offsetErr = fit.offset/256.0 - (c->x0 - W/2);
+        double slopeErr = fit.slope/256.0 - c->slope;
+        double curveErr = fit.curvature/65536.0 - c->curve;
+        printf("%-24s %8.3fpx %8.4f %10.5f %5d %7d\n", c->name, offsetErr, slopeErr, curveErr, fit.rows, fit.confidence);
+        CHECK(fabs(offsetErr) <= 0.5);
+        if (c->gap == 0){
+            CHECK(fabs(slopeErr) <= 0.03);
+            CHECK(fabs(curveErr) <= 0.002);
+            CHECK_EQ(fit.rows, LINEROWS);
+            CHECK(fit.confidence >= (c->noise ? 80 : 90));
+        }
+        else {
+            // the middle row is extrapolated from the rows below it
+            CHECK(fabs(slopeErr) <= 0.05);
+            CHECK(fit.rows < LINEROWS);
+            CHECK(fit.confidence < 90);
+        }
+    }
+}
+
+// a frame with no line can't be trusted
+static void testEmpty(){
+    int i;
+    lineFit_t fit;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    setLineDetector(LINE_CENTROID);
+    for(i=0;i<W*H*2;i++){
+        raw[i] = 0x42;
+    }
+    fitLineRaw(raw, &fit);
+    CHECK_EQ(fit.confidence, 0);
+}
+
+static void bench(){
+    int n;
+    int loops = 20000;
+    lineFit_t fit;
+    int32_t sum = 0;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    makeFrame(raw, &cases[5]);
+    setLineDetector(LINE_CENTROID);
+    uint64_t t = simNowNs();
+    for(n=0;n<loops;n++){
+        fitLineRaw(raw, &fit);
+        sum += fit.offset;
+    }
+    printf("fitLineRaw %.2fus per frame\n", (simNowNs() - t) / 1000.0 / loops);
+    CHECK(sum != 0);
+}
+
+int main(){
+    init_camera_pins();
+    testCases(LINE_CENTROID);
+    testCases(LINE_EDGE);
+    testEmpty();
+    bench();
+    return simResult("linefit");
+}
@@ -0,0 +1,235 @@
+// PIO backend: init_capture, startCapture and dma_handler run against the model of
+// cam.pio and its DMA channel in sim.c, fed by a simulated sensor
+#include <string.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define ROWBYTES (W*2)
+#define FRAMEBYTES (ROWBYTES*H)
+
+static uint8_t image[FRAMEBYTES];
+
+// dark floor with a white line at col, the first byte numbers the frame
+static void makeFrame(int col, uint8_t n){
+    int i;
+    for(i=0;i<W*H;i++){
+        int x = i % W;
+        uint16_t px = (x >= col - 3 && x <= col + 3) ? 0xFFFF : 0x2104;
+        image[2*i] = px & 0xFF;
+        image[2*i + 1] = px >> 8;
+    }
+    image[0] = n;
+}
+
+static void sendRows(int first, int rows){
+    int row;
+    for(row=first;row<first+rows;row++){
+        simRow(image + row*ROWBYTES, ROWBYTES);
+    }
+}
+
+static void sendFrame(){
+    simVsync();
+    sendRows(0, H);
+}
+
+// take the newest frame and check it against image
+static void checkFrame(int complete, int same){
+    frameInfo_t info;
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f < 0){
+        return;
+    }
+    getFrameInfo(f, &info);
+    CHECK_EQ(info.complete, complete);
+    CHECK_EQ(info.rows, H);
+    CHECK_EQ(info.bytes, FRAMEBYTES);
+    if (same){
+        CHECK(memcmp((uint8_t *)getFrameBuffer(f), image, FRAMEBYTES) == 0);
+    }
+    releaseFrame();
+}
+
+static void testFrames(){
+    int n;
+    uint32_t words = simPioWords;
+    uint32_t irqs = simDmaIrqs;
+
+    // one shot, the state machine stores 60 rows of 160 bytes, one DMA transfer
+    makeFrame(40, 1);
+    setSaveImage(1);
+    sendFrame();
+    CHECK_EQ(getSaveImage(), 0);
+    CHECK_EQ(getHSCount(), H);
+    CHECK_EQ(getPixelCount(), FRAMEBYTES);
+    CHECK_EQ(getFrameBytes(), 9600);
+    CHECK_EQ(simPioWords - words, FRAMEBYTES/4);
+    CHECK_EQ(simDmaIrqs - irqs, 1);
+    checkFrame(1, 1);
+
+    // nothing armed, the next frame goes nowhere
+    words = simPioWords;
+    sendFrame();
+    CHECK_EQ(simPioWords, words);
+    CHECK(acquireFrame() < 0);
+
+    // continuous, dma_handler arms the next buffer straight away
+    setContinuous(1);
+    for(n=0;n<5;n++){
+        makeFrame(10 + 10*n, 10 + n);
+        sendFrame();
+        checkFrame(1, 1);
+    }
+    setContinuous(0);
+    CHECK_EQ(getShortFrames(), 0);
+}
+
+// startCapture in the middle of a frame throws it away and waits for the next VS
+static void testRestart(){
+    int i;
+    uint32_t count = getFrameCount();
+
+    // between rows
+    makeFrame(20, 20);
+    setSaveImage(1);
+    simVsync();
+    sendRows(0, 30);
+    setSaveImage(1);
+    sendRows(30, H - 30);
+    CHECK_EQ(getFrameCount(), count);
+    makeFrame(60, 21);
+    sendFrame();
+    CHECK_EQ(getFrameCount(), count + 1);
+    CHECK_EQ(getHSCount(), H);
+    CHECK_EQ(getPixelCount(), FRAMEBYTES);
+    checkFrame(1, 1);
+
+    // half way through a row, with bytes still in the shift register
+    makeFrame(30, 22);
+    setSaveImage(1);
+    simVsync();
+    sendRows(0, 10);
+    simPin(HS, 1);
+    for(i=0;i<ROWBYTES/2+1;i++){
+        simPclk(image[10*ROWBYTES + i]);
+    }
+    setSaveImage(1);
+    for(;i<ROWBYTES;i++){
+        simPclk(image[10*ROWBYTES + i]);
+    }
+    simPin(HS, 0);
+    sendRows(11, H - 11);
+    makeFrame(50, 23);
+    sendFrame();
+    CHECK_EQ(getFrameCount(), count + 2);
+    checkFrame(1, 1);
+
+    // restarted in continuous mode
+    setContinuous(1);
+    makeFrame(45, 24);
+    simVsync();
+    sendRows(0, 20);
+    setContinuous(1);
+    sendRows(20, H - 20);
+    sendFrame();
+    CHECK_EQ(getFrameCount(), count + 3);
+    checkFrame(1, 1);
+    setContinuous(0);
+    CHECK_EQ(getShortFrames(), 0);
+}
+
+// the sensor sent fewer rows than armed, the state machine carries on into the
+// next frame and dma_handler sees two VS falls
+static void testShortFrame(){
+    uint32_t shortFrames = getShortFrames();
+    makeFrame(40, 30);
+    setSaveImage(1);
+    simVsync();
+    sendRows(0, 40);
+    sendFrame();
+    CHECK_EQ(getShortFrames(), shortFrames + 1);
+    checkFrame(0, 0);
+}
+
+// YUV422 with cam_capture_luma, the state machine keeps every other byte
+static void testLuma(){
+    int i;
+    setPixelFormat(OV7670_COLOR_YUV);
+    CHECK_EQ(getFrameBytes(), W*H);
+    for(i=0;i<FRAMEBYTES;i++){
+        image[i] = (i & 1) ? 0x80 : (uint8_t)(i >> 1);
+    }
+    setSaveImage(1);
+    sendFrame();
+    CHECK_EQ(getPixelCount(), W*H);
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f >= 0){
+        int bad = 0;
+        for(i=0;i<W*H;i++){
+            bad += getFrameBuffer(f)[i] != (uint8_t)i;
+        }
+        CHECK_EQ(bad, 0);
+        releaseFrame();
+    }
+    setPixelFormat(OV7670_COLOR_RGB);
+}
+
+// binning, DMA goes a row at a time into binRows and dma_handler re-arms it
+static void testBinning(){
+    int i;
+    CHECK_EQ(setBinning(2), 1);
+    CHECK_EQ(getFrameBytes(), (W/2)*(H/2));
+    for(i=0;i<W*H;i++){
+        uint16_t px = (i % W) < W/2 ? 0x0000 : 0xFFFF; // left half black
+        image[2*i] = px & 0xFF;
+        image[2*i + 1] = px >> 8;
+    }
+    uint32_t irqs = simDmaIrqs;
+    setSaveImage(1);
+    sendFrame();
+    CHECK_EQ(simDmaIrqs - irqs, H);
+    CHECK_EQ(getHSCount(), H);
+    CHECK_EQ(getPixelCount(), (W/2)*(H/2));
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f >= 0){
+        int bad = 0;
+        for(i=0;i<(W/2)*(H/2);i++){
+            bad += getFrameBuffer(f)[i] != ((i % (W/2)) < W/4 ? 0 : 250); // rgbLuma of 0xFFFF
+        }
+        CHECK_EQ(bad, 0);
+        CHECK_EQ(frameComplete(f), 1);
+        releaseFrame();
+    }
+    setBinning(1);
+}
+
+// sensor clock in kHz from MCLK and the CLKRC divider and DBLV PLL it was given
+static int sensorKhz(){
+    int pll[4] = {1, 4, 6, 8};
+    return 18750 * pll[simRegs[OV7670_REG_DBLV] >> 6] / ((simRegs[OV7670_REG_CLKRC] & 0x3F) + 1);
+}
+
+// fast mode only goes past the rated 24MHz when CAM_OVERCLOCK asks for it
+static void testClock(){
+    CHECK_EQ(sensorKhz(), 22500);
+    setFastMode(1);
+    CHECK_EQ(sensorKhz(), CAM_OVERCLOCK ? 37500 : 22500);
+    setFastMode(0);
+    CHECK_EQ(sensorKhz(), 22500);
+}
+
+int main(){
+    init_camera_pins();
+    testClock();
+    testFrames();
+    testRestart();
+    testShortFrame();
+    testLuma();
+    testBinning();
+    return simResult("pio");
+}
@@ -0,0 +1,134 @@
+// the register shadow: what reaches the camera over I2C for get, update, set and
+// flush, counted by the simulated bus, built with and without CAM_SCCB_BURST
+#include "cam.h"
+#include "sim.h"
+
+// set_register to what the camera has already costs nothing
+static void testNoop(){
+    OV7670_write_register(OV7670_REG_BRIGHT, 0x12);
+    simI2cClear();
+    OV7670_set_register(OV7670_REG_BRIGHT, 0xFF, 0x12);
+    OV7670_set_register(OV7670_REG_BRIGHT, 0x0F, 0x02);
+    OV7670_flush();
+    CHECK_EQ(simI2cWrites, 0);
+    CHECK_EQ(simI2cReads, 0);
+    OV7670_update_register(OV7670_REG_BRIGHT, 0xF0, 0x10);
+    CHECK_EQ(simI2cWrites, 0);
+}
+
+// a masked change keeps the other bits, known ones from the shadow, unknown ones read once
+static void testMasked(){
+    OV7670_write_register(OV7670_REG_CONTRAS, 0xA5);
+    simI2cClear();
+    OV7670_update_register(OV7670_REG_CONTRAS, 0x0F, 0x03);
+    CHECK_EQ(simRegs[OV7670_REG_CONTRAS], 0xA3);
+    CHECK_EQ(simI2cWrites, 1);
+    CHECK_EQ(simI2cReads, 0);
+
+    OV7670_set_register(OV7670_REG_CONTRAS, 0xF0, 0x50);
+    CHECK_EQ(OV7670_get_register(OV7670_REG_CONTRAS), 0x53); // waiting for the flush
+    CHECK_EQ(simRegs[OV7670_REG_CONTRAS], 0xA3);
+    OV7670_flush();
+    CHECK_EQ(simRegs[OV7670_REG_CONTRAS], 0x53);
+    CHECK_EQ(simI2cWrites, 2);
+    CHECK_EQ(simI2cReads, 0);
+}
+
+// after a COM7 reset nothing in the shadow is what the camera has
+static void testReset(){
+    OV7670_write_register(OV7670_REG_MVFP, 0x07);
+    OV7670_write_register(OV7670_REG_COM7, OV7670_COM7_RESET);
+    CHECK_EQ(simRegs[OV7670_REG_MVFP], 0);
+    simRegs[OV7670_REG_MVFP] = 0x01; // the camera's default
+    simI2cClear();
+    CHECK_EQ(OV7670_get_register(OV7670_REG_MVFP), 0x01);
+    CHECK_EQ(simI2cReads, 1);
+    CHECK_EQ(OV7670_get_register(OV7670_REG_MVFP), 0x01);
+    CHECK_EQ(simI2cReads, 1); // known now
+
+    // the same value as before the reset still has to be written
+    OV7670_write_register(OV7670_REG_BRIGHT, 0x12);
+    OV7670_write_register(OV7670_REG_COM7, OV7670_COM7_RESET);
+    simI2cClear();
+    OV7670_set_register(OV7670_REG_BRIGHT, 0xFF, 0x12);
+    OV7670_flush();
+    CHECK_EQ(simI2cWrites, 1);
+    CHECK_EQ(simRegs[OV7670_REG_BRIGHT], 0x12);
+}
+
+// registers auto gain owns are read again while it is on
+static void testAutoGain(){
+    OV7670_write_register(OV7670_REG_COM8, OV7670_COM8_AGC);
+    OV7670_write_register(OV7670_REG_GAIN, 0x10);
+    simRegs[OV7670_REG_GAIN] = 0x22; // AGC moved it
+    simI2cClear();
+    CHECK_EQ(OV7670_get_register(OV7670_REG_GAIN), 0x22);
+    CHECK_EQ(simI2cReads, 1);
+    OV7670_write_register(OV7670_REG_COM8, 0);
+    OV7670_write_register(OV7670_REG_GAIN, 0x10);
+    simI2cClear();
+    CHECK_EQ(OV7670_get_register(OV7670_REG_GAIN), 0x10);
+    CHECK_EQ(simI2cReads, 0);
+}
+
+// flush writes the dirty registers and nothing else, in runs of neighbours with
+// CAM_SCCB_BURST, one at a time without
+static void testFlush(){
+    int i;
+    for(i=0;i<40;i++){
+        OV7670_write_register(OV7670_REG_MTX1 + i, 0);
+    }
+    OV7670_write_register(OV7670_REG_HSTART, 0);
+    OV7670_write_register(OV7670_REG_HSTOP, 0);
+    OV7670_write_register(OV7670_REG_VSTART, 0);
+    OV7670_write_register(OV7670_REG_VSTOP, 0);
+    OV7670_write_register(OV7670_REG_MVFP, 0);
+    simI2cClear();
+    OV7670_set_register(OV7670_REG_HSTART, 0xFF, 0x11);
+    OV7670_set_register(OV7670_REG_HSTOP, 0xFF, 0x22);
+    OV7670_set_register(OV7670_REG_VSTART, 0xFF, 0x33);
+    OV7670_set_register(OV7670_REG_VSTOP, 0xFF, 0); // no change, so not dirty
+    OV7670_set_register(OV7670_REG_MVFP, 0xFF, 0x44);
+    for(i=0;i<40;i++){
+        OV7670_set_register(OV7670_REG_MTX1 + i, 0xFF, i + 1); // 40 in a row
+    }
+    CHECK_EQ(simI2cWrites, 0);
+    OV7670_flush();
+    CHECK_EQ(simRegs[OV7670_REG_HSTART], 0x11);
+    CHECK_EQ(simRegs[OV7670_REG_HSTOP], 0x22);
+    CHECK_EQ(simRegs[OV7670_REG_VSTART], 0x33);
+    CHECK_EQ(simRegs[OV7670_REG_MVFP], 0x44);
+    for(i=0;i<40;i++){
+        CHECK_EQ(simRegs[OV7670_REG_MTX1 + i], i + 1);
+    }
+#if CAM_SCCB_BURST
+    CHECK_EQ(simI2cWrites, 4);
+    CHECK_EQ(simI2cLog[0].reg, OV7670_REG_HSTART);
+    CHECK_EQ(simI2cLog[0].count, 3);
+    CHECK_EQ(simI2cLog[1].reg, OV7670_REG_MVFP);
+    CHECK_EQ(simI2cLog[1].count, 1);
+    CHECK_EQ(simI2cLog[2].reg, OV7670_REG_MTX1);
+    CHECK_EQ(simI2cLog[2].count, 32); // longest burst
+    CHECK_EQ(simI2cLog[3].reg, OV7670_REG_MTX1 + 32);
+    CHECK_EQ(simI2cLog[3].count, 8);
+#else
+    CHECK_EQ(simI2cWrites, 44);
+    for(i=0;i<SIMI2CLOG && i<44;i++){
+        CHECK_EQ(simI2cLog[i].count, 1);
+    }
+    CHECK_EQ(simI2cLog[3].reg, OV7670_REG_MVFP);
+#endif
+    simI2cClear();
+    OV7670_flush();
+    CHECK_EQ(simI2cWrites, 0); // all clean
+}
+
+int main(){
+    init_camera_pins();
+    testNoop();
+    testMasked();
+    testReset();
+    testAutoGain();
+    testFlush();
+    return simResult("sccb");
+}
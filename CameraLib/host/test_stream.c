@@ -0,0 +1,269 @@
+// encodeRle: the run lengths decoded like camframe.decode_rle must give back the
+// mask of a packed frame exactly, and the row average threshold of a raw one
+// encodeDelta: decoded like camframe.decode_delta it must give back the frame, and
+// sendImage in delta mode must send a raw keyframe every KEYINTERVAL frames
+// the delta stream is left in stream.bin and the frames sent in frames.bin for
+// check_stream.py to decode with camframe itself
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define FRAMEBYTES (W*H*2)
+#define KEYINTERVAL 30 // as in cam.c
+#define STREAMFRAMES 70
+
+static uint8_t runs[W*H*2];
+static uint8_t key[FRAMEBYTES];
+static uint8_t packed[FRAMEBYTES*2];
+static uint8_t sent[STREAMFRAMES][FRAMEBYTES];
+
+// runs alternate dark and light starting dark, into one byte per pixel
+static int decodeRle(const uint8_t *r, int n, uint8_t *mask){
+    int i;
+    int at = 0;
+    uint8_t white = 0;
+    for(i=0;i<n;i++){
+        if (at + r[i] > W*H){
+            return -1;
+        }
+        memset(mask + at, white, r[i]);
+        at += r[i];
+        white = !white;
+    }
+    return at;
+}
+
+static void checkPacked(const char *name){
+    uint8_t mask[W*H];
+    int bad = 0;
+    int i;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    uint32_t n = encodeRle(raw, runs, sizeof(runs));
+    CHECK(n < sizeof(runs));
+    CHECK_EQ(decodeRle(runs, n, mask), W*H);
+    for(i=0;i<W*H;i++){
+        bad += mask[i] != ((raw[i/8] >> (i & 7)) & 1);
+    }
+    if (bad){
+        printf("%s: %d pixels wrong\n", name, bad);
+    }
+    CHECK_EQ(bad, 0);
+}
+
+static void testPacked(){
+    int i;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    CHECK_EQ(setPackedFrames(1), 1);
+    for(i=0;i<getFrameBytes();i++){
+        raw[i] = 0;
+    }
+    checkPacked("all dark");
+    for(i=0;i<getFrameBytes();i++){
+        raw[i] = 0xFF;
+    }
+    checkPacked("all lit");
+    for(i=0;i<getFrameBytes();i++){
+        raw[i] = (i % (W/8)) == 5 ? 0x3C : 0; // a line
+    }
+    checkPacked("line");
+    for(i=0;i<getFrameBytes();i++){
+        raw[i] = simRand();
+    }
+    checkPacked("random");
+    setPackedFrames(0);
+}
+
+// RGB565 rows are cut at their average, so a row of one color is all light
+static void testRaw(){
+    uint8_t mask[W*H];
+    int i;
+    int lit = 0;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    for(i=0;i<W*H;i++){
+        uint16_t px = (i % W) >= 30 && (i % W) < 36 ? 0xFFFF : 0x2104;
+        raw[2*i] = px & 0xFF;
+        raw[2*i + 1] = px >> 8;
+    }
+    uint32_t n = encodeRle(raw, runs, sizeof(runs));
+    CHECK_EQ(decodeRle(runs, n, mask), W*H);
+    for(i=0;i<W*H;i++){
+        lit += mask[i];
+        if (mask[i]){
+            CHECK((i % W) >= 30 && (i % W) < 36);
+        }
+    }
+    CHECK_EQ(lit, 6*H);
+}
+
+// undo encodeDelta like camframe.decode_delta, -1 if it runs past the frame
+static int decodeDelta(const uint8_t *p, int n, const uint8_t *k, uint8_t *out, int bytes){
+    int i = 0;
+    int at = 0;
+    while (i < n){
+        int c = p[i++];
+        int len = c < 128 ? c + 1 : c - 126;
+        if (at + len > bytes || (c < 128 && i + len > n)){
+            return -1;
+        }
+        if (c < 128){
+            int j;
+            for(j=0;j<len;j++){
+                out[at + j] = p[i + j] ^ k[at + j];
+            }
+            i += len;
+        }
+        else {
+            memcpy(out + at, k + at, len);
+        }
+        at += len;
+    }
+    return at;
+}
+
+// encode raw against key, decode it back and compare, returns the packed size
+static int roundTrip(const char *name, volatile uint8_t *raw){
+    uint8_t out[FRAMEBYTES];
+    uint32_t n = encodeDelta(raw, key, packed, sizeof(packed));
+    CHECK(n < sizeof(packed));
+    CHECK_EQ(decodeDelta(packed, n, key, out, FRAMEBYTES), FRAMEBYTES);
+    if (memcmp(out, (const uint8_t *)raw, FRAMEBYTES) != 0){
+        printf("%s: delta did not decode back to the frame\n", name);
+        CHECK(0);
+    }
+    return n;
+}
+
+static void testDelta(){
+    int i;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    for(i=0;i<FRAMEBYTES;i++){
+        key[i] = simRand();
+        raw[i] = key[i];
+    }
+    // unchanged, zero runs of up to 129 bytes
+    CHECK_EQ(roundTrip("same", raw), (FRAMEBYTES + 128)/129);
+    // all changed, literals of up to 128 bytes
+    for(i=0;i<FRAMEBYTES;i++){
+        raw[i] = key[i] ^ 0x5A;
+    }
+    CHECK_EQ(roundTrip("all changed", raw), FRAMEBYTES + (FRAMEBYTES + 127)/128);
+    // a single matching byte between changed ones stays in the literal
+    raw[100] = key[100];
+    CHECK_EQ(roundTrip("one match", raw), FRAMEBYTES + (FRAMEBYTES + 127)/128);
+    // two matching bytes end it
+    raw[101] = key[101];
+    roundTrip("two match", raw);
+    // a few scattered changes
+    for(i=0;i<FRAMEBYTES;i++){
+        raw[i] = key[i];
+    }
+    for(i=0;i<50;i++){
+        raw[simRand() % FRAMEBYTES] ^= 1 + simRand() % 255;
+    }
+    CHECK(roundTrip("scattered", raw) < FRAMEBYTES/10);
+    // a change in the last byte, after a zero run
+    for(i=0;i<FRAMEBYTES;i++){
+        raw[i] = key[i];
+    }
+    raw[FRAMEBYTES - 1] ^= 1;
+    roundTrip("last byte", raw);
+    // too different to fit in limit
+    for(i=0;i<FRAMEBYTES;i++){
+        raw[i] = key[i] ^ 0xFF;
+    }
+    CHECK_EQ(encodeDelta(raw, key, packed, FRAMEBYTES), FRAMEBYTES);
+}
+
+// frame k of the stream: a line that moves a pixel a frame, and frame 45 noise,
+// too different from the keyframe before it and the frame after it for a delta
+static void streamFrame(uint8_t *frame, int k){
+    int i;
+    for(i=0;i<W*H;i++){
+        int x = i % W;
+        uint16_t px = (x >= 5 + k && x < 11 + k) ? 0xFFFF : 0x2104;
+        if (k == 45){
+            px = simRand();
+        }
+        frame[2*i] = px & 0xFF;
+        frame[2*i + 1] = px >> 8;
+    }
+}
+
+// send STREAMFRAMES frames in delta mode into stream.bin and read the headers back
+static void testSend(){
+    frameHeader_t h;
+    uint8_t out[FRAMEBYTES];
+    int k;
+    int keyAt = -1;
+    int keyframes = 0;
+    uint32_t keySeq = 0;
+
+    setStreamEncoding(FRAME_DELTA);
+    fflush(stdout);
+    int saved = dup(1);
+    int fd = open("stream.bin", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    dup2(fd, 1);
+    for(k=0;k<STREAMFRAMES;k++){
+        streamFrame(sent[k], k);
+        setSaveImage(1);
+        simFrame(sent[k], W*2, H);
+        sendImage();
+    }
+    fflush(stdout);
+    dup2(saved, 1);
+    close(fd);
+    close(saved);
+    setStreamEncoding(FRAME_RAW);
+
+    FILE *f = fopen("frames.bin", "wb");
+    CHECK(f != NULL);
+    fwrite(sent, 1, sizeof(sent), f);
+    fclose(f);
+
+    f = fopen("stream.bin", "rb");
+    CHECK(f != NULL);
+    for(k=0;k<STREAMFRAMES;k++){
+        if (fread(&h, sizeof(h), 1, f) != 1 || h.magic != FRAMEMAGIC || h.length > FRAMEBYTES
+            || fread(packed, 1, h.length, f) != h.length){
+            printf("frame %d: not in stream.bin\n", k);
+            CHECK(0);
+            break;
+        }
+        CHECK_EQ(h.crc, crc32(packed, h.length));
+        if (h.encoding == FRAME_RAW){
+            // the first, one every KEYINTERVAL after, and any a delta wouldn't make smaller
+            CHECK(keyAt < 0 || h.seq - keySeq == KEYINTERVAL || encodeDelta(sent[k], key, out, FRAMEBYTES) == FRAMEBYTES);
+            CHECK_EQ(h.length, FRAMEBYTES);
+            CHECK(memcmp(packed, sent[k], FRAMEBYTES) == 0);
+            memcpy(key, packed, FRAMEBYTES);
+            keyAt = k;
+            keyframes++;
+            keySeq = h.seq;
+        }
+        else {
+            CHECK_EQ(h.encoding, FRAME_DELTA);
+            CHECK(keyAt >= 0);
+            CHECK_EQ(h.ref, h.seq - keySeq);
+            CHECK(h.ref < KEYINTERVAL);
+            CHECK(h.length < FRAMEBYTES/4);
+            CHECK_EQ(decodeDelta(packed, h.length, key, out, FRAMEBYTES), FRAMEBYTES);
+            CHECK(memcmp(out, sent[k], FRAMEBYTES) == 0);
+        }
+    }
+    fclose(f);
+    CHECK_EQ(keyframes, 4); // 0, 30, 45 and 46
+}
+
+int main(){
+    init_camera_pins();
+    testPacked();
+    testRaw();
+    testDelta();
+    testSend();
+    return simResult("stream");
+}
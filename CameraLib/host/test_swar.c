@@ -0,0 +1,150 @@
+// rowCenter, the word at a time kernel, against the same center worked out a byte
+// at a time: it must give exactly the same answer on random rows in every frame
+// format, then the time per row of each and of findLine as it was before, on a
+// decoded picture with a float divide
+#include <string.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+
+// the scalar way: brightness of each pixel, the row average, then the center of
+// the pixels at or above it, in 1/256 pixels
+static int scalarCenter(volatile uint8_t *raw, int row, int *count){
+    uint16_t bright[W];
+    int sum = 0;
+    int n = 0;
+    int sumCol = 0;
+    int i;
+    int format = getPackedFrames() ? FRAME_FORMAT_MASK : getPixelFormat();
+    for(i=0;i<W;i++){
+        if (format == FRAME_FORMAT_MASK){
+            bright[i] = (raw[row*(W/8) + i/8] >> (i & 7)) & 1;
+        }
+        else if (format == OV7670_COLOR_YUV){
+            bright[i] = raw[row*W + i];
+        }
+        else {
+            uint8_t lo = raw[2*(row*W + i)];
+            uint8_t hi = raw[2*(row*W + i) + 1];
+            bright[i] = (hi & 0xF8) + ((((hi&0b111)<<3) | lo>>5)<<2) + ((lo&0b11111)<<3);
+        }
+        sum += bright[i];
+    }
+    int avg = format == FRAME_FORMAT_MASK ? 1 : sum / W;
+    for(i=0;i<W;i++){
+        if (bright[i] >= avg){
+            n++;
+            sumCol += i;
+        }
+    }
+    *count = n;
+    return n ? (sumCol << 8) / n : -256;
+}
+
+static cameraImage_t picture;
+
+// the old findLine, what benchLineDetectors times on the M33
+static int oldFindLine(cameraImage_t *p, int row){
+    int r = row*W;
+    int sumBright = 0;
+    int sumMass = 0;
+    int sumMassR = 0;
+    int i;
+    for(i=0;i<W;i++){
+        sumBright = sumBright + p->r[r+i] + p->g[r+i] + p->b[r+i];
+    }
+    int avgBright = sumBright / W;
+    for(i=0;i<W;i++){
+        int mass = p->r[r+i] + p->g[r+i] + p->b[r+i];
+        uint8_t v = mass < avgBright ? 0 : 255;
+        p->r[r+i] = v;
+        p->g[r+i] = v;
+        p->b[r+i] = v;
+    }
+    for(i=0;i<W;i++){
+        int mass = p->r[r+i] + p->g[r+i] + p->b[r+i];
+        sumMass = sumMass + mass;
+        sumMassR = sumMassR + mass*i;
+    }
+    if (sumMass == 0){
+        return -1;
+    }
+    float centerOfMass = (float)sumMassR / sumMass;
+    return (int)(centerOfMass);
+}
+
+// random rows, half of them with a bright band so there is a line to find
+static void fillRandom(volatile uint8_t *raw, int bytes){
+    int i;
+    for(i=0;i<bytes;i++){
+        raw[i] = simRand();
+    }
+    for(i=0;i<bytes/2;i+=bytes/H){
+        int start = simRand() % (bytes/H);
+        int width = simRand() % (bytes/H/4);
+        memset((uint8_t *)raw + i + start, 0xFF, start + width < bytes/H ? width : bytes/H - start);
+    }
+}
+
+static void compare(const char *name){
+    int trial;
+    int row;
+    int bad = 0;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    for(trial=0;trial<200;trial++){
+        fillRandom(raw, getFrameBytes());
+        for(row=0;row<H;row++){
+            int n1, n2;
+            int a = rowCenter(raw, row, &n1);
+            int b = scalarCenter(raw, row, &n2);
+            if (a != b || n1 != n2){
+                if (bad == 0){
+                    printf("%s row %d: rowCenter %d (%d px), scalar %d (%d px)\n", name, row, a, n1, b, n2);
+                }
+                bad++;
+            }
+        }
+    }
+    CHECK_EQ(bad, 0);
+
+    int loops = 20000;
+    int count;
+    int sum = 0;
+    uint64_t t = simNowNs();
+    for(trial=0;trial<loops;trial++){
+        sum += scalarCenter(raw, trial % H, &count);
+    }
+    double scalar = (double)(simNowNs() - t) / loops;
+    t = simNowNs();
+    for(trial=0;trial<loops;trial++){
+        sum -= rowCenter(raw, trial % H, &count);
+    }
+    double swar = (double)(simNowNs() - t) / loops;
+    CHECK_EQ(sum, 0);
+    // the old findLine needed the frame decoded first
+    t = simNowNs();
+    for(trial=0;trial<loops/H;trial++){
+        convertFrame(raw, &picture);
+    }
+    double convert = (double)(simNowNs() - t) / (loops/H*H);
+    t = simNowNs();
+    for(trial=0;trial<loops;trial++){
+        sum += oldFindLine(&picture, trial % H);
+    }
+    double old = (double)(simNowNs() - t) / loops + convert;
+    printf("%s: %d rows match, scalar %.1fns per row, rowCenter %.1fns per row, %.1fx\n",
+        name, 200*H, scalar, swar, scalar/swar);
+    printf("%s: old findLine with convertFrame %.1fns per row, %.1fx\n", name, old, old/swar);
+}
+
+int main(){
+    init_camera_pins();
+    compare("RGB565");
+    setPixelFormat(OV7670_COLOR_YUV);
+    compare("YUV");
+    CHECK_EQ(setPackedFrames(1), 1);
+    compare("packed");
+    return simResult("swar");
+}
@@ -0,0 +1,132 @@
+// otsuThreshold on histograms with and without something to split, and the packed
+// frames whose thresholds come from it, captured through the simulated sensor
+#include <string.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define ROWBYTES (W*2)
+#define GRAY 0x8410
+#define BLACK 0x0000
+
+static uint8_t image[ROWBYTES*H];
+
+static void testOtsu(){
+    uint16_t hist[HISTBINS];
+    int i;
+    uint8_t t;
+
+    memset(hist, 0, sizeof(hist));
+    CHECK_EQ(otsuThreshold(hist, 77), 77); // empty
+
+    hist[90] = 1000;
+    CHECK_EQ(otsuThreshold(hist, 77), 77); // one bin, all floor or all line
+
+    hist[100] = 20;
+    CHECK_EQ(otsuThreshold(hist, 77), 77); // closer than CAM_OTSU_SEPARATION
+
+    hist[200] = 50;
+    t = otsuThreshold(hist, 77);
+    CHECK(t >= 100 && t < 200);
+
+    // noisy floor and line
+    memset(hist, 0, sizeof(hist));
+    for(i=0;i<3000;i++){
+        hist[60 + simRand() % 20]++;
+    }
+    for(i=0;i<300;i++){
+        hist[180 + simRand() % 30]++;
+    }
+    t = otsuThreshold(hist, 0);
+    CHECK(t >= 79 && t < 180);
+
+    // noisy floor alone
+    memset(hist, 0, sizeof(hist));
+    for(i=0;i<3000;i++){
+        hist[60 + simRand() % 20]++;
+    }
+    CHECK_EQ(otsuThreshold(hist, 200), 200);
+}
+
+// white line at col on a floor of RGB565 color floor, or no line for col < 0
+static void makeFrame(int col, uint16_t floor){
+    int i;
+    for(i=0;i<W*H;i++){
+        int x = i % W;
+        uint16_t px = (col >= 0 && x >= col - 3 && x <= col + 3) ? 0xFFFF : floor;
+        image[2*i] = px & 0xFF;
+        image[2*i + 1] = px >> 8;
+    }
+}
+
+// capture rows of image packed and count the bits that came out set
+static int capturePacked(int rows){
+    int row;
+    int bits = 0;
+    int i;
+    setSaveImage(1);
+    simVsync();
+    for(row=0;row<rows;row++){
+        simRow(image + row*ROWBYTES, ROWBYTES);
+    }
+    if (rows < H){
+        simVsync(); // cut off
+    }
+    int f = acquireFrame();
+    CHECK(f >= 0);
+    if (f < 0){
+        return -1;
+    }
+    CHECK_EQ(frameComplete(f), rows == H);
+    for(i=0;i<getFrameBytes();i++){
+        bits += __builtin_popcount(getFrameBuffer(f)[i]);
+    }
+    releaseFrame();
+    return bits;
+}
+
+// a uniform frame must not throw away the thresholds the frames before found
+static void testPacked(){
+    CHECK_EQ(setPackedFrames(1), 1);
+    CHECK_EQ(getFrameBytes(), W/8*H);
+    makeFrame(40, GRAY);
+    CHECK_EQ(capturePacked(H), 0); // no thresholds yet
+    CHECK_EQ(capturePacked(H), 7*H);
+    makeFrame(-1, GRAY);
+    CHECK_EQ(capturePacked(H), 0);
+    CHECK_EQ(capturePacked(H), 0);
+    makeFrame(20, GRAY);
+    CHECK_EQ(capturePacked(H), 7*H);
+
+    // the rows of a frame that was cut off must not count towards the next
+    // thresholds, here they would pull them under the gray floor
+    makeFrame(-1, BLACK);
+    capturePacked(40);
+    makeFrame(20, GRAY);
+    CHECK_EQ(capturePacked(H), 7*H);
+    CHECK_EQ(capturePacked(H), 7*H);
+    setPackedFrames(0);
+}
+
+// the same for the picture convertFrame thresholds
+static void testPicture(){
+    int row;
+    int found = 0;
+    volatile uint8_t *raw = getFrameBuffer(0);
+    makeFrame(-1, GRAY);
+    memcpy((uint8_t *)raw, image, sizeof(image));
+    convertImage();
+    for(row=0;row<H;row++){
+        found += findLine(row) >= 0;
+    }
+    CHECK_EQ(found, 0);
+}
+
+int main(){
+    init_camera_pins();
+    testOtsu();
+    testPacked();
+    testPicture();
+    return simResult("threshold");
+}
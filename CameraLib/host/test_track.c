@@ -0,0 +1,172 @@
+// trackLine on made up frames with either line detector: locking on from a whole row,
+// coasting on the prediction and widening the window while the line is missing, giving
+// up after TRACK_LOST frames or once the prediction leaves the image, a line wider than
+// the window and glare next to the line
+#include <string.h>
+#include <stdlib.h>
+#include "cam.h"
+#include "sim.h"
+
+#define W 80
+#define H 60
+#define FLOOR 60
+#define LINE 230
+
+static uint8_t level[W];
+
+// every row of the frame buffer gray with the brightness in level[]
+static volatile uint8_t *useFrame(){
+    volatile uint8_t *raw = getFrameBuffer(0);
+    int i;
+    for(i=0;i<W*H;i++){
+        int v = level[i % W];
+        uint16_t px = ((v >> 3) << 11) | ((v >> 2) << 5) | (v >> 3);
+        raw[2*i] = px & 0xFF;
+        raw[2*i + 1] = px >> 8;
+    }
+    return raw;
+}
+
+// floor with a line over columns [from, to)
+static volatile uint8_t *lineFrame(int from, int to){
+    int i;
+    for(i=0;i<W;i++){
+        level[i] = (i >= from && i < to) ? LINE : FLOOR;
+    }
+    return useFrame();
+}
+
+// the first frame reads the whole row, after that a window a quarter of the row wide
+static void testLockOn(){
+    lineTrack_t track;
+    trackReset(&track);
+    CHECK_EQ(trackLine(&track, lineFrame(0, 0), H/2), -1);
+    CHECK_EQ(track.valid, 0);
+    CHECK_EQ(trackLine(&track, lineFrame(57, 63), H/2), 59);
+    CHECK_EQ(track.valid, 1);
+    CHECK_EQ(track.window, W/2);
+    CHECK_EQ(trackLine(&track, lineFrame(57, 63), H/2), 59);
+    CHECK_EQ(track.window, W >> CAM_TRACK_SHIFT);
+    CHECK_EQ(track.lost, 0);
+    // a crossing line outside the window is not seen
+    CHECK_EQ(trackLine(&track, lineFrame(0, 0), H/2), 59);
+    lineFrame(57, 63);
+    memset(level + 10, LINE, 20);
+    CHECK_EQ(trackLine(&track, useFrame(), H/2), 59);
+    CHECK_EQ(track.lost, 0);
+}
+
+// a line moving 2 pixels a frame goes missing: the tracker carries on where it would
+// have been with the window doubling each frame, then gives up and reads whole rows
+static void testCoast(){
+    lineTrack_t track;
+    int windows[TRACK_LOST];
+    int col;
+    int i;
+    trackReset(&track);
+    for(col=10;col<=30;col+=2){
+        // a pixel behind while it learns how fast
+        CHECK(abs(trackLine(&track, lineFrame(col, col + 6), H/2) - (col + 2)) <= 1);
+    }
+    CHECK_EQ(track.vel >> 8, 1);
+    col = 33;
+    for(i=0;i<TRACK_LOST-1;i++){
+        int got = trackLine(&track, lineFrame(0, 0), H/2);
+        CHECK(abs(got - col) <= 1);
+        CHECK_EQ(track.lost, i + 1);
+        CHECK_EQ(track.valid, 1);
+        windows[i] = track.window;
+        col += 2;
+    }
+    CHECK_EQ(trackLine(&track, lineFrame(0, 0), H/2), -1);
+    CHECK_EQ(track.valid, 0);
+    CHECK_EQ(windows[0], W >> CAM_TRACK_SHIFT);
+    CHECK(windows[1] > windows[0]);
+    CHECK(windows[2] > windows[1]);
+
+    // found again in the wider window the window narrows again
+    for(col=10;col<=30;col+=2){
+        trackLine(&track, lineFrame(col, col + 6), H/2);
+    }
+    CHECK_EQ(trackLine(&track, lineFrame(0, 0), H/2) >= 0, 1);
+    CHECK_EQ(trackLine(&track, lineFrame(40, 46), H/2) >= 0, 1);
+    CHECK_EQ(track.lost, 0);
+    CHECK_EQ(trackLine(&track, lineFrame(42, 48), H/2) >= 0, 1);
+    CHECK_EQ(track.window, W >> CAM_TRACK_SHIFT);
+}
+
+// a line heading out of the side is given up on as soon as it would be past it
+static void testLeave(){
+    lineTrack_t track;
+    int col;
+    int misses = 0;
+    trackReset(&track);
+    for(col=30;col+6<=W;col+=5){
+        trackLine(&track, lineFrame(col, col + 6), H/2);
+    }
+    while (trackLine(&track, lineFrame(0, 0), H/2) >= 0){
+        misses++;
+        CHECK(misses < TRACK_LOST);
+    }
+    CHECK(misses < TRACK_LOST-1);
+    CHECK_EQ(track.valid, 0);
+}
+
+// a line wider than the window fills it, that is the line and not the floor gone
+static void testWide(){
+    lineTrack_t track;
+    int i;
+    trackReset(&track);
+    CHECK_EQ(trackLine(&track, lineFrame(20, 56), H/2), 37);
+    for(i=0;i<TRACK_LOST*2;i++){
+        CHECK_EQ(trackLine(&track, lineFrame(20, 56), H/2), 37);
+        CHECK_EQ(track.valid, 1);
+    }
+    // while a floor as flat as that is not
+    trackLine(&track, lineFrame(0, 0), H/2);
+    CHECK_EQ(track.lost, 1);
+}
+
+// glare fading in right of the line is no edge, so LINE_EDGE stays on the line while
+// LINE_CENTROID takes the brighter part of it for line
+static void testGlare(){
+    lineTrack_t track;
+    int i;
+    int got;
+    lineFrame(38, 44);
+    for(i=45;i<W;i++){
+        int v = FLOOR + 11*(i - 44);
+        level[i] = v > 255 ? 255 : v;
+    }
+    useFrame();
+    setLineDetector(LINE_EDGE);
+    trackReset(&track);
+    for(i=0;i<20;i++){
+        got = trackLine(&track, useFrame(), H/2);
+    }
+    CHECK_EQ(got, 40);
+    setLineDetector(LINE_CENTROID);
+    trackReset(&track);
+    for(i=0;i<20;i++){
+        got = trackLine(&track, useFrame(), H/2);
+    }
+    CHECK(got != 40);
+}
+
+static void testAll(const char *name){
+    printf("%s\n", name);
+    testLockOn();
+    testCoast();
+    testLeave();
+    testWide();
+}
+
+int main(){
+    init_camera_pins();
+    setLineDetector(LINE_CENTROID);
+    testAll("LINE_CENTROID");
+    setLineDetector(LINE_EDGE);
+    testAll("LINE_EDGE");
+    testGlare();
+    return simResult("track");
+}
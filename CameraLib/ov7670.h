@@ -17,6 +17,8 @@
 #define OV7670_COM2_SSLEEP 0x10            //< COM2 soft sleep mode
 #define OV7670_REG_PID 0x0A                //< Product ID MSB (read-only)
 #define OV7670_REG_VER 0x0B                //< Product ID LSB (read-only)
+#define OV7670_PID 0x76                    //< PID of an OV7670
+#define OV7670_VER 0x73                    //< VER of an OV7670
 #define OV7670_REG_COM3 0x0C               //< Common control 3
 #define OV7670_COM3_SWAP 0x40              //< COM3 output data MSB/LSB swap
 #define OV7670_COM3_SCALEEN 0x08           //< COM3 scale enable
@@ -312,6 +314,21 @@ static const uint8_t OV7670_rgb[12][2] = {
     {0xff, 0xff},
 };
 
+static const uint8_t OV7670_yuv[3][2] = {
+    // Manual output format, YUV, use full output range
+    // TSLB[3] and COM13[0] are clear so bytes come out Y U Y V
+    {OV7670_REG_COM7, OV7670_COM7_YUV},
+    {OV7670_REG_COM15, OV7670_COM15_R00FF},
+
+    {0xff, 0xff},
+};
+
+/** Supported color formats */
+typedef enum {
+    OV7670_COLOR_RGB = 0, ///< RGB565
+    OV7670_COLOR_YUV,     ///< YUV 4:2:2, only the Y bytes are kept
+  } OV7670_colorspace;
+
 /** Supported sizes (VGA division factor) for OV7670_set_size() */
 typedef enum {
     OV7670_SIZE_DIV1 = 0, ///< 640 x 480
@@ -0,0 +1,24 @@
+# print the RAM a firmware's variables take, biggest first, run by camera_ram_report()
+# cmake -DNM=<nm> -DELF=<elf file> -P ram_report.cmake
+
+execute_process(COMMAND ${NM} --size-sort --reverse-sort --print-size --radix=d ${ELF}
+        OUTPUT_VARIABLE symbols
+        RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(WARNING "ram report: could not run ${NM} on ${ELF}")
+    return()
+endif()
+
+string(REPLACE "\n" ";" lines "${symbols}")
+set(total 0)
+foreach(line IN LISTS lines)
+    # address size type name, .bss and .data symbols are the ones in RAM
+    if(line MATCHES "^[0-9]+ ([0-9]+) [bBdD] (.+)$")
+        math(EXPR size "${CMAKE_MATCH_1}") # drops the leading zeros
+        math(EXPR total "${total} + ${size}")
+        if(size GREATER 255)
+            message("  ${size}\t${CMAKE_MATCH_2}")
+        endif()
+    endif()
+endforeach()
+message("RAM used by variables: ${total} bytes (those of 256 bytes or more listed above)")
@@ -0,0 +1,150 @@
+# read binary frames sent by sendImage() in CameraLib/cam.c
+# python3 -m pip install pyserial numpy
+
+import struct
+import zlib
+
+import numpy as np
+
+MAGIC = b'OVF1'
+# magic, seq, time, width, height, format, encoding, ref, length, crc
+HEADER = struct.Struct('<4sIIHHBBHII')
+
+FORMAT_RGB565 = 0
+FORMAT_Y = 1
+FORMAT_MASK = 2 # 1 bit per pixel, column 0 in bit 0, rows padded to whole bytes
+
+ENCODING_RAW = 0
+ENCODING_RLE = 1 # thresholded, run lengths starting with a dark run
+ENCODING_DELTA = 2 # XOR against the raw keyframe ref frames back, packed
+
+
+class Frame:
+    def __init__(self, seq, time, width, height, format, encoding, ref, payload):
+        self.seq = seq
+        self.time = time # microseconds on the pico
+        self.width = width
+        self.height = height
+        self.format = format
+        self.encoding = encoding
+        self.ref = ref
+        self.payload = payload # raw bytes as captured, once decoded
+        self.mask = None # height x width bool for ENCODING_RLE
+
+    def rgb(self):
+        # height x width x 3 uint8 array, same values as convertImage()
+        if self.mask is None and self.format == FORMAT_MASK:
+            self.mask = unpack_mask(self.payload, self.width, self.height)
+        if self.mask is not None:
+            m = self.mask.astype(np.uint8) * 255
+            return np.stack((m, m, m), axis=-1)
+        data = np.frombuffer(self.payload, dtype=np.uint8)
+        if self.format == FORMAT_Y:
+            y = data.reshape(self.height, self.width)
+            return np.stack((y, y, y), axis=-1)
+        lo = data[0::2].reshape(self.height, self.width)
+        hi = data[1::2].reshape(self.height, self.width)
+        r = (hi >> 3) << 3
+        g = (((hi & 0b111) << 3) | (lo >> 5)) << 2
+        b = (lo & 0b11111) << 3
+        return np.stack((r, g, b), axis=-1)
+
+    def brightness(self):
+        # height x width array of r+g+b, or Y, what findLine thresholds
+        if self.mask is None and self.format == FORMAT_MASK:
+            self.mask = unpack_mask(self.payload, self.width, self.height)
+        if self.mask is not None:
+            return self.mask.astype(np.int32) * 765
+        if self.format == FORMAT_Y:
+            return np.frombuffer(self.payload, dtype=np.uint8).reshape(self.height, self.width).astype(np.int32)
+        return self.rgb().astype(np.int32).sum(axis=-1)
+
+
+def parse(header, payload):
+    # build a Frame from a header and its payload, None if the CRC is wrong
+    magic, seq, time, width, height, format, encoding, ref, length, crc = HEADER.unpack(header)
+    if zlib.crc32(payload) != crc:
+        return None
+    return Frame(seq, time, width, height, format, encoding, ref, payload)
+
+
+def read_exact(ser, n):
+    data = ser.read(n)
+    while len(data) < n:
+        more = ser.read(n - len(data))
+        if not more:
+            raise TimeoutError('serial port timed out')
+        data += more
+    return data
+
+
+def read_frame(ser):
+    # skip any text the robot printed until the magic, then read one frame
+    # returns None if the frame was damaged
+    window = b''
+    while window != MAGIC:
+        window = (window + read_exact(ser, 1))[-4:]
+    header = MAGIC + read_exact(ser, HEADER.size - 4)
+    length = HEADER.unpack(header)[8]
+    payload = read_exact(ser, length)
+    return parse(header, payload)
+
+
+def decode_rle(runs, width, height):
+    # run lengths to a height x width bool mask, runs alternate dark, light
+    mask = np.zeros(width * height, dtype=bool)
+    i = 0
+    white = False
+    for run in runs:
+        mask[i:i + run] = white
+        i += run
+        white = not white
+    return mask.reshape(height, width)
+
+
+def unpack_mask(payload, width, height):
+    # packed frame to a height x width bool mask
+    stride = (width + 7) // 8
+    bits = np.unpackbits(np.frombuffer(payload, dtype=np.uint8), bitorder='little')
+    return bits.reshape(height, stride * 8)[:, :width].astype(bool)
+
+
+def decode_delta(packed, key):
+    # undo encodeDelta(): c < 128 is c+1 literal bytes, c >= 128 is c-126 zeros
+    out = bytearray(len(key))
+    i = 0
+    n = 0
+    while i < len(packed):
+        c = packed[i]
+        i += 1
+        if c < 128:
+            out[n:n + c + 1] = packed[i:i + c + 1]
+            i += c + 1
+            n += c + 1
+        else:
+            n += c - 126
+    return np.bitwise_xor(np.frombuffer(bytes(out), dtype=np.uint8), np.frombuffer(key, dtype=np.uint8)).tobytes()
+
+
+class Stream:
+    # reads frames in any encoding, keeping the keyframe deltas need
+    def __init__(self, ser):
+        self.ser = ser
+        self.key = None
+
+    def read(self):
+        # next decoded frame, None if damaged or its keyframe was missed
+        frame = read_frame(self.ser)
+        if frame is None:
+            return None
+        if frame.encoding == ENCODING_RAW:
+            self.key = frame
+        elif frame.encoding == ENCODING_RLE:
+            frame.mask = decode_rle(frame.payload, frame.width, frame.height)
+        elif frame.encoding == ENCODING_DELTA:
+            key = self.key
+            if key is None or key.seq != frame.seq - frame.ref or key.width != frame.width or key.height != frame.height or key.format != frame.format:
+                return None
+            frame.payload = decode_delta(frame.payload, key.payload)
+            frame.encoding = ENCODING_RAW
+        return frame
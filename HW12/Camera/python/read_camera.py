@@ -11,12 +11,9 @@ ser = serial.Serial('/dev/tty.usbmodem1101')
 print('Opening port: ')
 print(ser.name)
 
-import numpy as np
 from PIL import Image
 import matplotlib.pyplot as plt
-reds = np.zeros((60, 80), dtype=np.uint8)
-greens = np.zeros((60, 80), dtype=np.uint8)
-blues = np.zeros((60, 80), dtype=np.uint8)
+import camframe
 
 has_quit = False
 # menu loop
@@ -28,22 +25,15 @@ while not has_quit:
     ser.write(selection_endline.encode()); # .encode() turns the string into a char array
 
     if (selection == 'c'):
-        for t in range(4800):
-            dat_str = ser.read_until(b'\n'); 
-            i,r,g,b = list(map(int,dat_str.split())) 
-            row = i//80
-            col = i%80
-            reds[row][col] = r
-            greens[row][col] = g
-            blues[row][col] = b
-            print(i)
-            #print(str(i)+" "+str(r)+ " "+ str(g) + " " +str(b))
-
-        # Stack arrays to form an RGB image
-        rgb_array = np.stack((reds, greens, blues), axis=-1)
+        # the pico answers with sendImage(), one binary frame
+        frame = camframe.read_frame(ser)
+        if frame is None:
+            print('Bad frame, try again')
+            continue
+        print(frame.seq)
 
         # Convert to an image using PIL
-        image = Image.fromarray(rgb_array)
+        image = Image.fromarray(frame.rgb())
 
         # Display the image using Matplotlib
         plt.imshow(image)
@@ -0,0 +1,202 @@
+# record frames sent by sendImage() in CameraLib/cam.c into one preallocated,
+# memory-mapped file, and play them back to test vision code off the robot
+# python3 -m pip install pyserial numpy
+#
+# record:  python3 recorder.py record /dev/tty.usbmodem1101 run1.ovr --frames 2000 --frame-bytes 9600
+# list:    python3 recorder.py list run1.ovr
+#
+# replay from python:
+#   import recorder
+#   with recorder.Recording('run1.ovr') as rec:
+#       for frame in rec:
+#           b = frame.brightness()
+
+import argparse
+import mmap
+import struct
+import time
+
+import numpy as np
+
+import camframe
+
+# file layout: header, index of capacity entries, then the frames back to back
+# frames are stored decoded: raw as captured, RLE masks packed like FORMAT_MASK
+MAGIC = b'OVR1'
+# magic, capacity, count, index offset, data offset, data size
+HEADER = struct.Struct('<4sIIQQQ')
+# offset, length, seq, pico time, host time ns, width, height, format
+ENTRY = struct.Struct('<QIIIQHHB3x')
+
+
+class Recorder:
+    # appends frames to a file sized up front, the header count is written last
+    # so a recording cut off halfway still opens with every frame before it
+    def __init__(self, path, frames, frame_bytes=320 * 240 * 2):
+        self.capacity = frames
+        self.index_offset = HEADER.size
+        self.data_offset = self.index_offset + frames * ENTRY.size
+        self.data_size = frames * frame_bytes
+        self.file = open(path, 'w+b')
+        self.file.truncate(self.data_offset + self.data_size)
+        self.map = mmap.mmap(self.file.fileno(), 0)
+        self.count = 0
+        self.used = 0
+        self._write_header()
+
+    def _write_header(self):
+        HEADER.pack_into(self.map, 0, MAGIC, self.capacity, self.count,
+                         self.index_offset, self.data_offset, self.data_size)
+
+    def append(self, frame, host_ns=None):
+        # store one decoded camframe.Frame, False if the file is full
+        if frame.mask is not None and frame.format != camframe.FORMAT_MASK:
+            payload = np.packbits(frame.mask, axis=1, bitorder='little').tobytes()
+            format = camframe.FORMAT_MASK
+        else:
+            payload = bytes(frame.payload)
+            format = frame.format
+        if self.count == self.capacity or self.used + len(payload) > self.data_size:
+            return False
+        offset = self.data_offset + self.used
+        self.map[offset:offset + len(payload)] = payload
+        ENTRY.pack_into(self.map, self.index_offset + self.count * ENTRY.size,
+                        offset, len(payload), frame.seq, frame.time,
+                        time.time_ns() if host_ns is None else host_ns,
+                        frame.width, frame.height, format)
+        self.used += len(payload)
+        self.count += 1
+        self._write_header()
+        return True
+
+    def close(self):
+        # keep the preallocated size, Recording only reads what the index points at
+        self.map.flush()
+        self.map.close()
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+class Recording:
+    # read only view of a recorded file, frames are camframe.Frame objects whose
+    # payload points straight into the mapped file
+    def __init__(self, path):
+        self.file = open(path, 'rb')
+        self.map = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, self.capacity, self.count, self.index_offset, self.data_offset, self.data_size = HEADER.unpack_from(self.map, 0)
+        if magic != MAGIC:
+            raise ValueError(path + ' is not a recording')
+        self.view = memoryview(self.map)
+
+    def __len__(self):
+        return self.count
+
+    def entry(self, i):
+        # offset, length, seq, pico time, host time ns, width, height, format
+        if i < 0:
+            i += self.count
+        if i < 0 or i >= self.count:
+            raise IndexError(i)
+        return ENTRY.unpack_from(self.map, self.index_offset + i * ENTRY.size)
+
+    def __getitem__(self, i):
+        offset, length, seq, pico_time, host_ns, width, height, format = self.entry(i)
+        frame = camframe.Frame(seq, pico_time, width, height, format,
+                               camframe.ENCODING_RAW, 0, self.view[offset:offset + length])
+        frame.host_ns = host_ns
+        return frame
+
+    def __iter__(self):
+        for i in range(self.count):
+            yield self[i]
+
+    def find(self, seq):
+        # index of the frame with this sequence number, -1 if it wasn't recorded
+        for i in range(self.count):
+            if self.entry(i)[2] == seq:
+                return i
+        return -1
+
+    def play(self, speed=1.0):
+        # frames paced by their pico timestamps, speed 2 is twice as fast
+        start = time.monotonic()
+        first = None
+        for frame in self:
+            if first is None:
+                first = frame.time
+            due = ((frame.time - first) & 0xFFFFFFFF) / 1e6 / speed
+            wait = due - (time.monotonic() - start)
+            if wait > 0:
+                time.sleep(wait)
+            yield frame
+
+    def close(self):
+        # frames still held keep the mapping alive until they are dropped
+        try:
+            self.view.release()
+            self.map.close()
+        except BufferError:
+            pass
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+def record(port, path, frames, frame_bytes, request):
+    import serial
+    ser = serial.Serial(port, timeout=2)
+    print('Opening port: ' + str(ser.name))
+    stream = camframe.Stream(ser)
+    bad = 0
+    with Recorder(path, frames, frame_bytes) as rec:
+        try:
+            while rec.count < frames:
+                if request:
+                    ser.write('c\n'.encode()) # one frame per c, like read_camera.py
+                frame = stream.read()
+                if frame is None:
+                    bad += 1
+                    continue
+                if not rec.append(frame):
+                    break
+                if rec.count % 100 == 0:
+                    print('%d frames, %d bad' % (rec.count, bad))
+        except KeyboardInterrupt:
+            pass
+        print('recorded %d frames, %d bad, %d bytes' % (rec.count, bad, rec.used))
+    ser.close()
+
+
+def list_frames(path):
+    with Recording(path) as rec:
+        print('%d of %d frames' % (len(rec), rec.capacity))
+        for i in range(len(rec)):
+            offset, length, seq, pico_time, host_ns, width, height, format = rec.entry(i)
+            print('%d seq %d time %d %dx%d format %d %d bytes' % (i, seq, pico_time, width, height, format, length))
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    sub = parser.add_subparsers(dest='command', required=True)
+    p = sub.add_parser('record')
+    p.add_argument('port')
+    p.add_argument('path')
+    p.add_argument('--frames', type=int, default=1000)
+    p.add_argument('--frame-bytes', type=int, default=320 * 240 * 2, help='room per frame, 9600 for 80x60 RGB565')
+    p.add_argument('--no-request', action='store_true', help="the robot sends frames without being asked")
+    p = sub.add_parser('list')
+    p.add_argument('path')
+    args = parser.parse_args()
+    if args.command == 'record':
+        record(args.port, args.path, args.frames, args.frame_bytes, not args.no_request)
+    else:
+        list_frames(args.path)
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
 #include "cam.h"
+#include "prof.h"
 #include "hardware/pwm.h"
 
 // Motor pin definitions
@@ -9,6 +10,16 @@
 #define M2F 17  // Right motor forward pin
 #define M2B 16  // Right motor backward pin
 
+// 1 to decode full pictures on core1 so setPixel/printImage can be used,
+// 0 to find the line straight from the raw frame
+#define DEBUG_PICTURE 0
+
+// 1 to time the line detectors on one frame at start up and print cycles per row
+#define BENCH_DETECTORS 0
+
+// 1 to stream every frame to HW12/Camera/python/camframe.py, p shows what it costs as send
+#define SEND_FRAMES 0
+
 // PWM configuration
 #define WRAP_VALUE 12500 // PWM wrap value (125MHz/12500 = 10kHz PWM freq)
 
@@ -16,6 +27,7 @@ float pid_range = 0.8f;
 int line_center = 25;
 int spread_left = 41;
 int spread_right = 11;
+float heading_gain = 0.0f; // extra control per pixel/row of line slope, 0 = offset only, tune on the track
 
 // PWM slice IDs for each pin
 uint slice_num_m1f;
@@ -111,20 +123,66 @@ int main()
 
     printf("Hello, camera!\n");
     init_camera_pins();
+    //setFastMode(1); // short fixed exposure if the line blurs when the robot moves, needs a bright track
+    printf("frame period %d us\n", (int)measureFramePeriod(5));
 
     printf("Line Bot Simple Control Started\n");
     setup_motors();
  
+#if DEBUG_PICTURE
+    startCameraCore1(); // core1 captures and decodes, this core steers
+#else
+#if BENCH_DETECTORS
+    setSaveImage(1); // one frame to time the line detectors on
+    while (getSaveImage()){}
+    acquireFrame();
+    benchLineDetectors();
+    releaseFrame(); // old by the time the loop starts, don't steer on it
+#endif
+    setLineDetector(LINE_CENTROID); // LINE_EDGE if glare or shadows pull the line off
+    setContinuous(1); // capture the next frame while this one is processed
+#endif
+
+#if !DEBUG_PICTURE
+    int com = line_center; // last line estimate, kept while the view doesn't change
+    lineFit_t fit = {0};
+    lineTrack_t track;
+    trackReset(&track);
+#endif
+    profStart(); // send p over serial to print where the time goes, r to reset
     while (true) {
         // uncomment these and printImage() when testing with python 
         //char m[10];
         //scanf("%s",m);
 
-        setSaveImage(1);
-        while(getSaveImage()==1){}
-        convertImage();
-        int com = findLine(IMAGESIZEY/2); // calculate the position of the center of the line
-        setPixel(IMAGESIZEY/2,com,0,255,0); // draw the center so you can see it in python
+#if DEBUG_PICTURE
+        cameraFrame_t frame;
+        waitPicture(&frame);
+        profMark(PROF_WAIT);
+        profAdd(PROF_AGE, time_us_32() - frame.time);
+        int com = findLine(getImageHeight()/2); // calculate the position of the center of the line
+        setPixel(getImageHeight()/2,com,0,255,0); // draw the center so you can see it in python
+#else
+        int f = acquireFrame();
+        if (f < 0){
+            continue; // no new frame yet
+        }
+        if (!frameComplete(f)){
+            releaseFrame(); // torn, keep steering on the last good one
+            continue;
+        }
+        profMark(PROF_WAIT);
+        profAdd(PROF_AGE, time_us_32() - getFrameTime(f));
+        if (frameChanged(f)){
+            int c = trackLineFrame(&track, getImageHeight()/2); // only reads the part of the row the line should be in
+            if (c >= 0){
+                com = c;
+            }
+            fitLineFrame(&fit); // how the line bends across the image
+        }
+        releaseFrame();
+#endif
+        profMark(PROF_VISION);
         
         // Map com value based on defined ranges
         float control;
@@ -155,9 +213,31 @@ int main()
             }
         }
         
+#if !DEBUG_PICTURE
+        // lean into curves before the middle row drifts off center
+        if (fit.confidence >= 50){
+            control = control + heading_gain * (float)fit.slope / 256.0f;
+        }
+#endif
+
+        profMark(PROF_CONTROL);
+
         //printImage();
         printf("%d,%0.2f\r\n", com, control); // print both com and control values
+#if DEBUG_PICTURE
+        if (frame.seq % 100 == 0){
+            printf("core0 %d%% core1 %d%%\r\n", (int)getCoreLoad(0), (int)getCoreLoad(1));
+        }
+#endif
+        profMark(PROF_PRINT);
+#if SEND_FRAMES
+        sendImage(); // the last whole frame, the header and payload in two writes
+#endif
+        profMark(PROF_SEND);
         drive_robot(control); // Control the robot based on the line position
+        profMark(PROF_DRIVE);
+        profPoll();
+        profEnd();
     }
 }
 
@@ -0,0 +1,94 @@
+#include "prof.h"
+
+static const char *const stageNames[PROF_STAGES] = {"wait", "age", "vision", "control", "print", "send", "drive", "loop"};
+
+static profStats_t stats[PROF_STAGES];
+static uint32_t loopStart = 0; // time_us_32 at profStart
+static uint32_t lastMark = 0; // time_us_32 at the last probe
+
+// forget everything measured so far
+void profReset(){
+    int i;
+    for(i=0;i<PROF_STAGES;i++){
+        stats[i] = (profStats_t){0};
+        stats[i].min = 0xFFFFFFFF;
+    }
+}
+
+// copy out one stage, for use in code
+void profGet(prof_stage stage, profStats_t *out){
+    *out = stats[stage];
+}
+
+// print every stage, min/mean/max then the histogram counts
+void profPrint(){
+    int i;
+    int b;
+    printf("stage count min mean max us, histogram 0 1 2-3 4-7 ...\r\n");
+    for(i=0;i<PROF_STAGES;i++){
+        profStats_t *s = &stats[i];
+        if (s->count == 0){
+            continue;
+        }
+        printf("%s %d %d %d %d,", stageNames[i], (int)s->count, (int)s->min, (int)(s->sum / s->count), (int)s->max);
+        for(b=0;b<PROFBUCKETS;b++){
+            printf(" %d", (int)s->hist[b]);
+        }
+        printf("\r\n");
+    }
+}
+
+#if PROFILE
+// record one time for a stage
+void profAdd(prof_stage stage, uint32_t us){
+    profStats_t *s = &stats[stage];
+    if (s->count == 0){
+        s->min = 0xFFFFFFFF; // first use, or never reset
+    }
+    s->count++;
+    s->sum = s->sum + us;
+    if (us < s->min){
+        s->min = us;
+    }
+    if (us > s->max){
+        s->max = us;
+    }
+    // bucket is the number of bits in us
+    int b = us ? 32 - __builtin_clz(us) : 0;
+    if (b >= PROFBUCKETS){
+        b = PROFBUCKETS - 1;
+    }
+    s->hist[b]++;
+}
+
+// call before the loop
+void profStart(){
+    loopStart = time_us_32();
+    lastMark = loopStart;
+}
+
+// call when a stage finishes, it gets the time since the previous probe
+void profMark(prof_stage stage){
+    uint32_t now = time_us_32();
+    profAdd(stage, now - lastMark);
+    lastMark = now;
+}
+
+// call at the bottom of the loop, records the whole pass and starts the next
+void profEnd(){
+    profAdd(PROF_LOOP, time_us_32() - loopStart);
+    profStart();
+}
+
+// check for a command from the computer without blocking,
+// p prints the stats, r resets them
+void profPoll(){
+    int c = getchar_timeout_us(0);
+    if (c == 'p'){
+        profPrint();
+    }
+    else if (c == 'r'){
+        profReset();
+    }
+}
+#endif
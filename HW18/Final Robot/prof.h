@@ -0,0 +1,52 @@
+#ifndef PROF_h
+#define PROF_h
+
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+// time the stages of the control loop, set to 0 to compile the probes out
+#ifndef PROFILE
+#define PROFILE 1
+#endif
+
+// stages of one pass through the loop in camera.c
+typedef enum {
+    PROF_WAIT = 0, // waiting for a frame
+    PROF_AGE, // frame finished to the loop getting it, capture to vision latency
+    PROF_VISION, // finding and fitting the line
+    PROF_CONTROL, // line to control value
+    PROF_PRINT, // printf to the computer
+    PROF_SEND, // sendImage to the computer, only with SEND_FRAMES in camera.c
+    PROF_DRIVE, // setting the motors
+    PROF_LOOP, // the whole pass
+    PROF_STAGES
+} prof_stage;
+
+#define PROFBUCKETS 16 // histogram bucket n counts times from 2^(n-1) to 2^n-1 us, the last one everything longer
+
+typedef struct profStats{
+    uint32_t count;
+    uint32_t min; // us
+    uint32_t max; // us
+    uint64_t sum; // us, mean is sum/count
+    uint32_t hist[PROFBUCKETS];
+} profStats_t;
+
+#if PROFILE
+void profStart();
+void profMark(prof_stage stage);
+void profAdd(prof_stage stage, uint32_t us);
+void profEnd();
+void profPoll();
+#else
+#define profStart()
+#define profMark(stage)
+#define profAdd(stage, us)
+#define profEnd()
+#define profPoll()
+#endif
+void profReset();
+void profGet(prof_stage stage, profStats_t *stats);
+void profPrint();
+
+#endif